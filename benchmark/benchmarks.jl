@@ -0,0 +1,196 @@
+
+# Micro-benchmarks of the NumQuad native layer (BenchmarkTools).
+#
+# `SUITE` follows the PkgBenchmark convention, so
+#    using PkgBenchmark; judge("SciAlgs", "master")
+# compares two commits. Run as a script to tune, run and save the results
+# as JSON (default benchmark/results.json):
+#    julia --project=benchmark benchmark/benchmarks.jl [results.json]
+#
+# The C/C++ counterpart is src/NumQuad/lebedev/benchmark (Google Benchmark).
+
+using BenchmarkTools
+import Libdl
+using SciAlgs.NumQuad: LIBLEBEDEV, lebedev_laikov_table, lebedev_laikov_wrapper,
+                       reproducible_sum
+
+const SUITE = BenchmarkGroup()
+
+const LEBEDEV_ORDERS = [6,    14,   26,   38,   50,   74,   86,   110,  146,  170,  194,
+                        230,  266,  302,  350,  434,  590,  770,  974,  1202, 1454, 1730,
+                        2030, 2354, 2702, 3074, 3470, 3890, 4334, 4802, 5294, 5810]
+
+function ld_by_order!(x, y, z, w)
+   ccall((:ld_by_order, LIBLEBEDEV), Cint,
+         (Cint, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}),
+         length(x), x, y, z, w)
+end
+
+function gen_oh!(code, x, y, z, w)
+   ccall((:gen_oh, LIBLEBEDEV), Cint,
+         (Cint, Float64, Float64, Float64, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}),
+         code, 0.3, 0.5, 1.0, x, y, z, w)
+end
+
+# Runtime generation of every rule
+SUITE["ld_by_order"] = BenchmarkGroup()
+for n in LEBEDEV_ORDERS
+   x, y, z, w = zeros(n), zeros(n), zeros(n), zeros(n)
+   SUITE["ld_by_order"][n] = @benchmarkable ld_by_order!($x, $y, $z, $w)
+end
+
+# One orbit of every symmetry code, 6 to 48 points
+SUITE["gen_oh"] = BenchmarkGroup()
+for code in 1:6
+   x, y, z, w = zeros(48), zeros(48), zeros(48), zeros(48)
+   SUITE["gen_oh"][code] = @benchmarkable gen_oh!($code, $x, $y, $z, $w)
+end
+
+# Call overhead of the same table lookup through ccall and through CxxWrap
+# (src/interface_cxx/5_lebedev, when it has been built)
+SUITE["ffi"] = BenchmarkGroup()
+SUITE["ffi"]["ccall"] = @benchmarkable lebedev_laikov_table(302)
+
+const CPPLEBEDEV = joinpath(@__DIR__, "..", "src", "interface_cxx", "5_lebedev")
+if isdir(joinpath(CPPLEBEDEV, "build", "lib"))
+   include(joinpath(CPPLEBEDEV, "testlib.jl"))
+   SUITE["ffi"]["cxxwrap"] = @benchmarkable (CppLebedev.lebedev_points(302),
+                                             CppLebedev.lebedev_weights(302))
+else
+   @info "CxxWrap benchmarks skipped: run $(joinpath(CPPLEBEDEV, "build.sh")) first"
+end
+
+# Marshalling arrays of objects: boxed C++ objects in a StdVector versus an
+# isbits mirror read in place (src/interface_cxx/2_class, when built)
+const CPPCLASS = joinpath(@__DIR__, "..", "src", "interface_cxx", "2_class")
+if isdir(joinpath(CPPCLASS, "build", "lib"))
+   include(joinpath(CPPCLASS, "testlib.jl"))
+   SUITE["ffi"]["arrays"] = BenchmarkGroup()
+   for n in (10^3, 10^5)
+      boxed = StdVector([CppClass.Foo(1) for _ in 1:n])
+      bits  = fill(CppClass.FooBits(1), n)
+      SUITE["ffi"]["arrays"]["StdVector{Foo}", n] = @benchmarkable CppClass.sumfoos($boxed)
+      SUITE["ffi"]["arrays"]["Vector{FooBits}", n] = @benchmarkable CppClass.sumfoos($bits)
+   end
+else
+   @info "CxxWrap array benchmarks skipped: run $(joinpath(CPPCLASS, "build.sh")) first"
+end
+
+# Scalar-per-call versus batched (array-in/array-out) kernels of the C,
+# Fortran and Rust interop examples, against plain Julia. The per-element
+# time of each, over n, shows where batching pays for the call overhead;
+# see batching_crossover below. C and Fortran are compiled here when their
+# compilers are found, Rust when call_rust has been built (build.sh).
+const INTEROP = joinpath(@__DIR__, "..", "src")
+const BATCH_SIZES = [1, 2, 4, 8, 16, 64, 256, 1024, 4096]
+const INTEROP_LIBS = Dict{String,String}()
+
+let dir = mktempdir()
+   if Sys.which("gcc") !== nothing
+      lib = joinpath(dir, "libmean." * Libdl.dlext)
+      run(`gcc -shared -O3 -fopenmp-simd -fPIC -o $lib $(joinpath(INTEROP, "interface_c", "calc_mean.c"))`)
+      INTEROP_LIBS["c"] = lib
+   end
+   if Sys.which("gfortran") !== nothing
+      lib = joinpath(dir, "libmypow." * Libdl.dlext)
+      source = joinpath(INTEROP, "interface_fortran", "iso_c", "fortran_iso_c.f90")
+      cd(() -> run(`gfortran -shared -O3 -fopenmp-simd -fPIC -o $lib $source`), dir)
+      INTEROP_LIBS["fortran"] = lib
+   end
+   lib = joinpath(INTEROP, "interface_rust", "call_rust", "target", "release",
+                  "libmy_rust_lib." * Libdl.dlext)
+   isfile(lib) && (INTEROP_LIBS["rust"] = lib)
+end
+
+# (scalar kernel, batched kernel, Julia kernel, inputs) of every language
+function interop_kernels(lang, lib)
+   handle = Libdl.dlopen(lib)
+   if lang == "c"
+      mean, mean_batch = Libdl.dlsym(handle, :mean), Libdl.dlsym(handle, :mean_batch)
+      scalar = (out, a, b) -> for i in eachindex(out)
+         out[i] = ccall(mean, Cdouble, (Cdouble, Cdouble), a[i], b[i])
+      end
+      batched = (out, a, b) -> ccall(mean_batch, Cvoid,
+                                     (Ptr{Cdouble}, Ptr{Cdouble}, Ptr{Cdouble}, Int64),
+                                     a, b, out, length(out))
+      julia = (out, a, b) -> (out .= (a .+ b) ./ 2)
+      inputs = n -> (zeros(n), rand(n), rand(n))
+   elseif lang == "fortran"
+      mypow, mypow_batch = Libdl.dlsym(handle, :mypow), Libdl.dlsym(handle, :mypow_batch)
+      scalar = (out, a) -> for i in eachindex(out)
+         r = Ref{Clonglong}(a[i])
+         ccall(mypow, Cvoid, (Ref{Clonglong},), r)
+         out[i] = r[]
+      end
+      batched = (out, a) -> ccall(mypow_batch, Cvoid, (Ptr{Clonglong}, Ptr{Clonglong}, Int64),
+                                  a, out, length(out))
+      julia = (out, a) -> (out .= a .^ 2)
+      inputs = n -> (zeros(Clonglong, n), rand(Clonglong(1):Clonglong(1000), n))
+   else
+      # no scalar loop: double_input prints on every call
+      double_batch = Libdl.dlsym(handle, :double_input_batch)
+      scalar = nothing
+      batched = (out, a) -> ccall(double_batch, Cvoid, (Ptr{Int32}, Ptr{Int32}, Int64),
+                                  a, out, length(out))
+      julia = (out, a) -> (out .= 2 .* a)
+      inputs = n -> (zeros(Int32, n), rand(Int32(1):Int32(1000), n))
+   end
+   scalar, batched, julia, inputs
+end
+
+SUITE["ffi"]["batched"] = BenchmarkGroup()
+for (lang, lib) in INTEROP_LIBS
+   scalar, batched, julia, inputs = interop_kernels(lang, lib)
+   group = SUITE["ffi"]["batched"][lang] = BenchmarkGroup()
+   for n in BATCH_SIZES
+      args = inputs(n)
+      scalar === nothing || (group["scalar", n] = @benchmarkable $scalar($args...))
+      group["batched", n] = @benchmarkable $batched($args...)
+      group["julia", n] = @benchmarkable $julia($args...)
+   end
+end
+isempty(INTEROP_LIBS) && @info "Batched interop benchmarks skipped: no gcc, gfortran or Rust build"
+
+# Smallest n at which the batched kernel of every language is at least as
+# fast per element as `other` ("scalar" or "julia"), from run(SUITE) results
+function batching_crossover(results, other="scalar")
+   crossover = Dict{String,Union{Int,Nothing}}()
+   for (lang, group) in results["ffi"]["batched"]
+      crossover[lang] = nothing
+      for n in BATCH_SIZES
+         haskey(group, (other, n)) || continue
+         if time(median(group["batched", n])) ≤ time(median(group[other, n]))
+            crossover[lang] = n
+            break
+         end
+      end
+   end
+   crossover
+end
+
+# End to end: nearest order, table lookup and copies
+SUITE["lebedev_laikov_wrapper"] = BenchmarkGroup()
+for n in LEBEDEV_ORDERS
+   SUITE["lebedev_laikov_wrapper"][n] = @benchmarkable lebedev_laikov_wrapper($n)
+end
+
+# Compensated, multithreaded native sum against Base's pairwise sum
+SUITE["reductions"] = BenchmarkGroup()
+for n in (10^3, 10^5, 10^7)
+   x = rand(n)
+   SUITE["reductions"]["reproducible_sum", n] = @benchmarkable reproducible_sum($x)
+   SUITE["reductions"]["reproducible_sum, 1 thread", n] = @benchmarkable reproducible_sum($x, nthreads=1)
+   SUITE["reductions"]["sum", n] = @benchmarkable sum($x)
+end
+
+if abspath(PROGRAM_FILE) == @__FILE__
+   output = isempty(ARGS) ? joinpath(@__DIR__, "results.json") : ARGS[1]
+   tune!(SUITE)
+   results = run(SUITE, verbose=true)
+   BenchmarkTools.save(output, results)
+   println(median(results))
+   if !isempty(INTEROP_LIBS)
+      println("Batched kernels win over per-element calls from n = ", batching_crossover(results))
+      println("  and over plain Julia from n = ", batching_crossover(results, "julia"))
+   end
+end
@@ -100,7 +100,7 @@ function R(t,u,v,n,p,PCx,PCy,PCz,RPC)
       if t > 1
          val += (t-1)*R(t-2,u,v,n+1,p,PCx,PCy,PCz,RPC) # (9.9.18)
       end
-      val += PCy*R(t-1,u,v,n+1,p,PCx,PCy,PCz,RPC)      # (9.9.18)
+      val += PCx*R(t-1,u,v,n+1,p,PCx,PCy,PCz,RPC)      # (9.9.18)
    end
    val
 end
@@ -158,7 +158,7 @@ function electron_repulsion(a,lmn1,A,b,lmn2,B,c,lmn3,C,d,lmn4,D)
    RPQ = norm(P-Q)
    val = 0.0
    for t in 0:l1+l2, u in 0:m1+m2, v in 0:n1+n2,
-       τ in 0:l3+l4, ν in 0:m3+m3, ϕ in 0:n3+n4
+       τ in 0:l3+l4, ν in 0:m3+m4, ϕ in 0:n3+n4
       val += E(l1,l2,t,A[1]-B[1],a,b) *
              E(m1,m2,u,A[2]-B[2],a,b) *
              E(n1,n2,v,A[3]-B[3],a,b) *
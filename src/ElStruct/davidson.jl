@@ -3,9 +3,11 @@
 
 using LinearAlgebra
 
+# A only has to provide A * SS, size and eltype, so structured operators
+# (e.g. the FFT-based Hamiltonian of dft.jl) are never formed densely
 function davidson(A, SS::AbstractArray; maxiter=100, prec=I,
                   tol=20size(A,2)*eps(eltype(A)),
-                  maxsubspace=8size(SS, 2))
+                  maxsubspace=8size(SS, 2), verbose=true)
     m = size(SS, 2)
     for i in 1:maxiter
         Ass = A * SS
@@ -21,7 +23,7 @@ function davidson(A, SS::AbstractArray; maxiter=100, prec=I,
             return rvals, SS * rvecs
         end
 
-        println(i, "  ", size(SS, 2), "  ", norm(R))
+        verbose && println(i, "  ", size(SS, 2), "  ", norm(R))
 
         # Use QR to orthogonalise the subspace.
         if size(SS, 2) + m > maxsubspace
@@ -33,8 +35,10 @@ function davidson(A, SS::AbstractArray; maxiter=100, prec=I,
     error("not converged.")
 end
 
-# Test Davidson algorithm
+# Test Davidson algorithm (when run as a script, not when included)
 # ------------------------
+if abspath(PROGRAM_FILE) == @__FILE__
+
 nev = 2
 A = randn(20, 20); A = A + A' + I;
 
@@ -50,4 +54,4 @@ E,V = eigen(A)
 isapprox(E_Davidson, E[1:nev],   atol=1e-4) || error("Inaccurate eigenvalues")
 isapprox(V_Davidson, V[:,1:nev], atol=1e-4) || error("Inaccurate eigenvectors") # sometimes fails
 
-
+end
@@ -1,7 +1,8 @@
 # A simple plane wave Density Functional Theory (DFT) code
 # https://github.com/mpanho/simple-DFT/blob/master/DFT_1D.ipynb
+import FFTW
 import FFTW: fft, ifft
-import LinearAlgebra: eigen, Diagonal, diagm #, ishermitian, LAPACK.syev!
+import LinearAlgebra: eigen, Diagonal, LAPACK #, ishermitian
 import SpecialFunctions: erfcx
 import Interpolations: CubicSplineInterpolation
 
@@ -28,18 +29,63 @@ function kinetic(k)
   Diagonal((k.+ G).^2 ./rs^2)
 end
 
+include("davidson.jl")
+
+# The potential in the plane-wave basis, V_{GG'} = V(G-G'), is circulant:
+# P[i,j] = V[mod(i-j,nG)+1], diagonalised by the FFT. Nothing nG×nG is
+# stored and P*x costs O(nG log nG) instead of O(nG²).
+struct CirculantOp{T} <: AbstractMatrix{T}
+  c::Vector{T}           # first column
+  λ::Vector{ComplexF64}  # eigenvalues, fft(c)
+end
+
+CirculantOp(c::AbstractVector) = CirculantOp(collect(c), fft(c))
+
+Base.size(P::CirculantOp) = (length(P.c), length(P.c))
+Base.getindex(P::CirculantOp, i::Int, j::Int) = P.c[mod(i-j, length(P.c))+1]
+
+function circulant_mul(P::CirculantOp{T}, X) where T
+  Y = ifft(P.λ .* fft(X, 1), 1)
+  T <: Real && eltype(X) <: Real ? real.(Y) : Y
+end
+Base.:*(P::CirculantOp, x::AbstractVector) = circulant_mul(P, x)
+Base.:*(P::CirculantOp, X::AbstractMatrix) = circulant_mul(P, X)
+
 function potential_op(V)
-  tmp = zeros(nG,nG)
-  #tmp += Diagonal(ones(nG)*V[1])
-  tmp += diagm( 0 => ones(nG)*V[1])
-  for i in 0:(nG-2)
-    tmp += diagm( i+1 => ones(nG-i-1)*V[end-i])
-    tmp += diagm(-i-1 => ones(nG-i-1)*V[i+2])
+  CirculantOp(V)
+end
+
+# H = T(k) + V without forming it: diagonal kinetic plus circulant potential
+struct PlaneWaveHamiltonian{T} <: AbstractMatrix{T}
+  t::Vector{Float64}
+  V::CirculantOp{T}
+end
+
+Base.size(H::PlaneWaveHamiltonian) = size(H.V)
+Base.getindex(H::PlaneWaveHamiltonian, i::Int, j::Int) = (i == j ? H.t[i] : 0) + H.V[i,j]
+Base.:*(H::PlaneWaveHamiltonian, x::AbstractVector) = H.t .* x + H.V * x
+Base.:*(H::PlaneWaveHamiltonian, X::AbstractMatrix) = H.t .* X + H.V * X
+
+# Lowest nB bands by Davidson on the matrix-free H, started from the nB
+# lowest plane waves and preconditioned with the kinetic energy
+function erwin(V::CirculantOp; tol=1e-9)
+  bandst = zeros(nk,nB)
+  wfk = zeros(Complex{Float64},nk,nG,nB)
+  for i in 1:nk
+    H = PlaneWaveHamiltonian(kinetic(kvec[i]).diag, V)
+    X0 = zeros(eltype(H), nG, nB)
+    for (j, iG) in enumerate(sortperm(H.t)[1:nB])
+      X0[iG, j] = 1
+    end
+    eig, v = davidson(H, X0; tol=tol, prec=Diagonal(1 ./ (1 .+ H.t)),
+                      maxsubspace=min(nG, 8nB), verbose=false)
+    bandst[i,:] = eig
+    wfk[i,:,:] = v
   end
-  tmp
+  bandst, wfk
 end
 
-function erwin(V)
+function erwin(V::AbstractMatrix)
   bandst = zeros(nk,nB)
   wfk = zeros(Complex{Float64},nk,nG,nB)
   for i in 1:nk
@@ -63,12 +109,58 @@ function occupation(eigenvalue)
   end
 end
 
-function calc_ρ(occ,wfk)
-  ρ = zeros(nG)
-  for ik in 1:nk, jn in 1:nB
-    ρ += 2occ[ik,jn] .* abs.(IFFT(wfk[ik,:,jn])).^2
+# Buffers of calc_ρ!, one set per thread (or per chunk of k-points): a
+# wavefunction, its in-place backward FFT plan (IFFT without the 1/nG),
+# and a partial density
+struct DensityWorkspace{P}
+  ψ::Vector{Vector{ComplexF64}}
+  plans::Vector{P}
+  ρ::Vector{Vector{Float64}}
+end
+
+function DensityWorkspace(nG, nchunks=Threads.nthreads())
+  ψ = [zeros(ComplexF64, nG) for _ in 1:nchunks]
+  plans = [FFTW.plan_bfft!(ψ[t]; flags=FFTW.MEASURE) for t in 1:nchunks]
+  DensityWorkspace(ψ, plans, [zeros(nG) for _ in 1:nchunks])
+end
+
+# Density of the k-points ik0, ik0+step, ... into ws.ρ[t]
+function accumulate_ρ!(ws, t, occ, wfk, ik0, step)
+  ψ, plan, ρt = ws.ψ[t], ws.plans[t], ws.ρ[t]
+  fill!(ρt, 0)
+  for ik in ik0:step:size(wfk, 1), jn in 1:size(wfk, 3)
+    for iG in eachindex(ψ)
+      ψ[iG] = wfk[ik,iG,jn]
+    end
+    plan * ψ   # in place
+    w = 2occ[ik,jn]
+    @inbounds @simd for iG in eachindex(ρt)
+      ρt[iG] += w * abs2(ψ[iG])
+    end
+  end
+  ρt
+end
+
+# ρ = ∑ₖₙ 2fₖₙ |ψₖₙ(x)|² / (2a nk), with no allocations (one thread) once
+# the workspace exists; threads sum disjoint k-points into their own ws.ρ
+function calc_ρ!(ρ, occ, wfk, ws, a)
+  nchunks = length(ws.ψ)
+  if nchunks == 1
+    accumulate_ρ!(ws, 1, occ, wfk, 1, 1)
+  else
+    Threads.@threads for t in 1:nchunks
+      accumulate_ρ!(ws, t, occ, wfk, t, nchunks)
+    end
+  end
+  copyto!(ρ, ws.ρ[1])
+  for t in 2:nchunks
+    ρ .+= ws.ρ[t]
   end
-  ρ /= 2a*nk
+  ρ ./= 2a*size(wfk, 1)
+end
+
+function calc_ρ(occ,wfk)
+  calc_ρ!(zeros(nG), occ, wfk, DensityWorkspace(nG), a)
 end
 
 function coul_pot(r,rs)
@@ -139,6 +231,8 @@ Vin = potential_op(VextG)
 eigs, vs = eigen(kinetic(0) + Vin)
 
 bandst, wfk = erwin(Vin)
+# Same bands as the dense diagonalisation
+@assert isapprox(bandst, erwin(Matrix(Vin))[1], atol=1e-8)
 
 # Guess the Fermi level
 EFermi = 0.0
@@ -219,7 +313,14 @@ Vxc = @. ex(rs_ρ(ρ)) - vx(rs_ρ(ρ))* rs_ρ(ρ) + Ecorr(rs_ρ(ρ)) - vc(rs_ρ(
 
 Vin = potential_op(VextG + FFT(VH(ρ) + Vxc))
 
-ρ_old = ρ
+ρ_old = copy(ρ)
+ρ_ws = DensityWorkspace(nG)
+ρ_new = zeros(nG)
+# the density stage allocates nothing (single thread)
+calc_ρ!(ρ_new, occ, wfk, ρ_ws, a)
+density_allocations(ρ, occ, wfk, ws, a) = @allocated calc_ρ!(ρ, occ, wfk, ws, a)
+Threads.nthreads() == 1 && @assert density_allocations(ρ_new, occ, wfk, ρ_ws, a) == 0
+@assert ρ_new ≈ calc_ρ(occ, wfk)
 
 residual = [1.0]
 nmax = 15
@@ -230,7 +331,8 @@ mix = 0.4
 i = 1
 while residual[end] > 5e-4 && i <= nmax
   bandst, wfk = erwin(Vin)
-  global ρ = ρ*(1-mix) + mix*(calc_ρ(occ,wfk))
+  calc_ρ!(ρ_new, occ, wfk, ρ_ws, a)
+  ρ .= ρ.*(1-mix) .+ mix.*ρ_new
   Vxc = @. ex(rs_ρ(ρ)) + vx(rs_ρ(ρ))*ρ + Ecorr(rs_ρ(ρ)) + vc(rs_ρ(ρ)) * ρ
   global Vin = potential_op(VextG + FFT(VH(ρ) + Vxc))
   global i += 1
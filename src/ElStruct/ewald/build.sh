@@ -0,0 +1,5 @@
+
+rm -Rf build
+mkdir build && cd build
+cmake -DCMAKE_BUILD_TYPE=Release ..
+cmake --build . --config Release
@@ -0,0 +1,439 @@
+# include <cmath>
+# include <cstdlib>
+# include <new>
+# include <vector>
+
+# ifdef _OPENMP
+# include <omp.h>
+# endif
+
+# include "ewald.h"
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    Arena of scratch memory, see ewald.h.
+
+  Discussion:
+
+    Memory is handed out from a list of blocks by bumping an offset. When a
+    request does not fit in what is left, the next block (or a new one, at
+    least twice the size of the last) is used. Giving memory back rewinds
+    to a mark; a full reset also merges several blocks into a single one as
+    large as all of them, so after the first calls a workspace serves every
+    call of the same size from one block.
+*/
+struct ewald_workspace
+{
+  struct Block
+  {
+    char *data;
+    size_t size;
+  };
+  struct Mark
+  {
+    size_t block, offset;
+  };
+
+  static constexpr size_t ALIGNMENT = 64;
+
+  std::vector<Block> blocks;
+  size_t block = 0;
+  size_t offset = 0;
+  long mallocs = 0;
+
+  ewald_workspace ( ) = default;
+  ewald_workspace ( const ewald_workspace & ) = delete;
+  ewald_workspace &operator= ( const ewald_workspace & ) = delete;
+
+  ~ewald_workspace ( )
+  {
+    for ( const Block &b : blocks )
+    {
+      std::free ( b.data );
+    }
+  }
+
+  bool reserve ( size_t bytes )
+  {
+    bytes = ( bytes + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT;
+    char *data = static_cast<char *> ( std::aligned_alloc ( ALIGNMENT, bytes ) );
+    if ( data == nullptr )
+    {
+      return false;
+    }
+    blocks.push_back ( { data, bytes } );
+    mallocs++;
+    return true;
+  }
+
+  void *take ( size_t bytes )
+  {
+    bytes = ( bytes + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT;
+    while ( block < blocks.size ( ) )
+    {
+      if ( bytes <= blocks[block].size - offset )
+      {
+        void *p = blocks[block].data + offset;
+        offset += bytes;
+        return p;
+      }
+      block++;
+      offset = 0;
+    }
+    const size_t last = blocks.empty ( ) ? 0 : blocks.back ( ).size;
+    if ( !reserve ( bytes < 2 * last ? 2 * last : bytes ) )
+    {
+      return nullptr;
+    }
+    block = blocks.size ( ) - 1;
+    offset = bytes;
+    return blocks[block].data;
+  }
+
+  template <typename T> T *take ( size_t n )
+  {
+    return static_cast<T *> ( take ( n * sizeof ( T ) ) );
+  }
+
+  Mark mark ( ) const
+  {
+    return { block, offset };
+  }
+
+  void release ( Mark m )
+  {
+    block = m.block;
+    offset = m.offset;
+    if ( block == 0 && offset == 0 && 1 < blocks.size ( ) )
+    {
+      reset ( );
+    }
+  }
+
+  void reset ( )
+  {
+    block = 0;
+    offset = 0;
+    if ( blocks.size ( ) <= 1 )
+    {
+      return;
+    }
+    size_t total = 0;
+    for ( const Block &b : blocks )
+    {
+      total += b.size;
+      std::free ( b.data );
+    }
+    blocks.clear ( );
+/*
+  If the merged block cannot be had, start empty and grow again
+*/
+    reserve ( total );
+  }
+};
+
+namespace
+{
+
+/*
+  Scratch of the calls given no workspace
+*/
+thread_local ewald_workspace scratch;
+
+/*
+  Gives back on scope exit everything taken from WS after construction
+*/
+class ScratchScope
+{
+public:
+  explicit ScratchScope ( ewald_workspace &ws ) : ws_ ( ws ), mark_ ( ws.mark ( ) ) { }
+  ~ScratchScope ( ) { ws_.release ( mark_ ); }
+
+private:
+  ewald_workspace &ws_;
+  ewald_workspace::Mark mark_;
+};
+
+}
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    Real- and reciprocal-space lattice sums of Ewald's method.
+
+  Discussion:
+
+    The real-space sum runs over lattice vectors R in parallel; for each R
+    and ion i the pair terms with every ion j are evaluated in one SIMD loop
+    (erfc and exp from libmvec, see CMakeLists.txt).
+
+    The reciprocal-space sum uses the structure factor, O(nat) per
+    reciprocal vector. exp(i 2pi K.x) is the product of per-axis tables
+    exp(i 2pi K_k x_k), so that no trigonometric function is evaluated
+    inside the loop over K, and only half of the K are visited since
+    |S(-h)| = |S(h)|.
+
+  Reference:
+
+    Michael Allen, Dominic Tildesley,
+    Computer Simulation of Liquids, section 5.5.2,
+    Oxford University Press, 1989.
+*/
+namespace
+{
+
+int threads ( int nthreads )
+{
+# ifdef _OPENMP
+  return 0 < nthreads ? nthreads : omp_get_max_threads ( );
+# else
+  return 1;
+# endif
+}
+
+/*
+  Squared norm of the crystallographic vector D under the metric G.
+*/
+inline double norm2 ( const double *G, double d1, double d2, double d3 )
+{
+  return G[0] * d1 * d1 + G[4] * d2 * d2 + G[8] * d3 * d3
+       + 2.0 * ( G[3] * d1 * d2 + G[6] * d1 * d3 + G[7] * d2 * d3 );
+}
+
+double real_sum ( int nat, const double *G, const double *x, const double *y,
+  const double *z, const double *q, double alpha, double rcut, const int *rmax,
+  int nthreads )
+{
+  const long n1 = 2 * rmax[0] + 1;
+  const long n2 = 2 * rmax[1] + 1;
+  const long n3 = 2 * rmax[2] + 1;
+  double sum = 0.0;
+
+# pragma omp parallel for reduction(+:sum) schedule(dynamic) num_threads(threads(nthreads))
+  for ( long r = 0; r < n1 * n2 * n3; r++ )
+  {
+    const double R1 = ( double ) ( r / ( n2 * n3 ) - rmax[0] );
+    const double R2 = ( double ) ( ( r / n3 ) % n2 - rmax[1] );
+    const double R3 = ( double ) ( r % n3 - rmax[2] );
+
+    for ( int i = 0; i < nat; i++ )
+    {
+      const double xi = x[i] - R1;
+      const double yi = y[i] - R2;
+      const double zi = z[i] - R3;
+      double e = 0.0;
+
+# pragma omp simd reduction(+:e)
+      for ( int j = 0; j < nat; j++ )
+      {
+        double rij = std::sqrt ( norm2 ( G, xi - x[j], yi - y[j], zi - z[j] ) );
+/*
+  Discard self-interaction (R=[0,0,0] && i==j) and far ions
+*/
+        double near = ( 1e-12 < rij && rij < rcut ) ? 1.0 : 0.0;
+        rij = near != 0.0 ? rij : 1.0;
+        e += near * q[j] * std::erfc ( alpha * rij ) / rij;
+      }
+      sum += q[i] * e;
+    }
+  }
+  return 0.5 * sum;
+}
+
+double recip_sum ( int nat, const double *G, const double *x, const double *y,
+  const double *z, const double *q, double alpha, double hcut, const int *kmax,
+  int nthreads, double *const c[3], double *const s[3] )
+{
+  const double det = G[0] * ( G[4] * G[8] - G[7] * G[5] )
+                   - G[3] * ( G[1] * G[8] - G[7] * G[2] )
+                   + G[6] * ( G[1] * G[5] - G[4] * G[2] );
+  const double Ginv[9] = {
+    ( G[4] * G[8] - G[5] * G[7] ) / det,
+    ( G[2] * G[7] - G[1] * G[8] ) / det,
+    ( G[1] * G[5] - G[2] * G[4] ) / det,
+    ( G[5] * G[6] - G[3] * G[8] ) / det,
+    ( G[0] * G[8] - G[2] * G[6] ) / det,
+    ( G[2] * G[3] - G[0] * G[5] ) / det,
+    ( G[3] * G[7] - G[4] * G[6] ) / det,
+    ( G[1] * G[6] - G[0] * G[7] ) / det,
+    ( G[0] * G[4] - G[1] * G[3] ) / det };
+  const double volume = std::sqrt ( det );
+
+/*
+  cos and sin of 2pi k x_i for 0 <= k <= kmax, stored [k*nat+i] per axis;
+  negative k are the complex conjugates
+*/
+  const double *coords[3] = { x, y, z };
+  for ( int a = 0; a < 3; a++ )
+  {
+    for ( int k = 0; k <= kmax[a]; k++ )
+    {
+      double *ck = c[a] + k * ( long ) nat;
+      double *sk = s[a] + k * ( long ) nat;
+      const double *u = coords[a];
+# pragma omp simd
+      for ( int i = 0; i < nat; i++ )
+      {
+        ck[i] = std::cos ( 2.0 * M_PI * k * u[i] );
+        sk[i] = std::sin ( 2.0 * M_PI * k * u[i] );
+      }
+    }
+  }
+
+  const long n1 = 2 * kmax[0] + 1;
+  const long n2 = 2 * kmax[1] + 1;
+  const long n3 = 2 * kmax[2] + 1;
+  double sum = 0.0;
+
+# pragma omp parallel for reduction(+:sum) schedule(dynamic) num_threads(threads(nthreads))
+  for ( long k = 0; k < n1 * n2 * n3; k++ )
+  {
+    const int K1 = ( int ) ( k / ( n2 * n3 ) ) - kmax[0];
+    const int K2 = ( int ) ( ( k / n3 ) % n2 ) - kmax[1];
+    const int K3 = ( int ) ( k % n3 ) - kmax[2];
+/*
+  Half space K > 0 (lexicographically), K = 0 excluded
+*/
+    if ( K1 < 0 || ( K1 == 0 && ( K2 < 0 || ( K2 == 0 && K3 <= 0 ) ) ) )
+    {
+      continue;
+    }
+    const double h1 = 2.0 * M_PI * K1;
+    const double h2 = 2.0 * M_PI * K2;
+    const double h3 = 2.0 * M_PI * K3;
+    const double h = std::sqrt ( norm2 ( Ginv, h1, h2, h3 ) );
+    if ( !( 1e-12 < h && h < hcut ) )
+    {
+      continue;
+    }
+
+    const double *c1 = c[0] + K1 * ( long ) nat;
+    const double *s1 = s[0] + K1 * ( long ) nat;
+    const double *c2 = c[1] + std::abs ( K2 ) * ( long ) nat;
+    const double *s2 = s[1] + std::abs ( K2 ) * ( long ) nat;
+    const double *c3 = c[2] + std::abs ( K3 ) * ( long ) nat;
+    const double *s3 = s[2] + std::abs ( K3 ) * ( long ) nat;
+    const double sign2 = K2 < 0 ? -1.0 : 1.0;
+    const double sign3 = K3 < 0 ? -1.0 : 1.0;
+
+    double re = 0.0;
+    double im = 0.0;
+# pragma omp simd reduction(+:re,im)
+    for ( int i = 0; i < nat; i++ )
+    {
+      double ar = c1[i] * c2[i] - s1[i] * sign2 * s2[i];
+      double ai = c1[i] * sign2 * s2[i] + s1[i] * c2[i];
+      re += q[i] * ( ar * c3[i] - ai * sign3 * s3[i] );
+      im += q[i] * ( ar * sign3 * s3[i] + ai * c3[i] );
+    }
+
+    const double exponent = ( 0.5 * h / alpha ) * ( 0.5 * h / alpha );
+    sum += 2.0 * ( re * re + im * im ) / ( h * h ) * std::exp ( -exponent );
+  }
+  return 2.0 * M_PI / volume * sum;
+}
+
+}
+
+/******************************************************************************/
+
+ewald_workspace *ewald_workspace_new ( size_t bytes )
+{
+  ewald_workspace *ws = new ( std::nothrow ) ewald_workspace;
+  if ( ws != nullptr && 0 < bytes && !ws->reserve ( bytes ) )
+  {
+    delete ws;
+    ws = nullptr;
+  }
+  return ws;
+}
+
+void ewald_workspace_free ( ewald_workspace *ws )
+{
+  delete ws;
+}
+
+void ewald_workspace_reset ( ewald_workspace *ws )
+{
+  ws->reset ( );
+}
+
+size_t ewald_workspace_capacity ( const ewald_workspace *ws )
+{
+  size_t total = 0;
+  for ( const ewald_workspace::Block &b : ws->blocks )
+  {
+    total += b.size;
+  }
+  return total;
+}
+
+long ewald_workspace_mallocs ( const ewald_workspace *ws )
+{
+  return ws->mallocs;
+}
+
+/******************************************************************************/
+
+int ewald_sums ( int nat, const double *G, const double *positions,
+  const double *q, double alpha, double rcut, const int *rmax, double hcut,
+  const int *kmax, int nthreads, double *real, double *recip )
+{
+  return ewald_sums_ws ( nullptr, nat, G, positions, q, alpha, rcut, rmax,
+    hcut, kmax, nthreads, real, recip );
+}
+
+int ewald_sums_ws ( ewald_workspace *ws, int nat, const double *G,
+  const double *positions, const double *q, double alpha, double rcut,
+  const int *rmax, double hcut, const int *kmax, int nthreads,
+  double *real, double *recip )
+{
+  if ( nat <= 0 || !( 0.0 < alpha ) )
+  {
+    return EWALD_EINVAL;
+  }
+  for ( int k = 0; k < 3; k++ )
+  {
+    if ( rmax[k] < 0 || kmax[k] < 0 )
+    {
+      return EWALD_EINVAL;
+    }
+  }
+
+  ewald_workspace &arena = ws ? *ws : scratch;
+  ScratchScope scope ( arena );
+
+/*
+  Structure of arrays for the SIMD loops, and the phase tables
+*/
+  double *x = arena.take<double> ( nat );
+  double *y = arena.take<double> ( nat );
+  double *z = arena.take<double> ( nat );
+  double *c[3], *s[3];
+  bool ok = x && y && z;
+  for ( int k = 0; k < 3; k++ )
+  {
+    c[k] = arena.take<double> ( ( kmax[k] + 1 ) * ( size_t ) nat );
+    s[k] = arena.take<double> ( ( kmax[k] + 1 ) * ( size_t ) nat );
+    ok = ok && c[k] && s[k];
+  }
+  if ( !ok )
+  {
+    return EWALD_ENOMEM;
+  }
+
+  for ( int i = 0; i < nat; i++ )
+  {
+    x[i] = positions[3*i];
+    y[i] = positions[3*i+1];
+    z[i] = positions[3*i+2];
+  }
+
+  *real = real_sum ( nat, G, x, y, z, q, alpha, rcut, rmax, nthreads );
+  *recip = recip_sum ( nat, G, x, y, z, q, alpha, hcut, kmax, nthreads, c, s );
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+/*
+  Native Ewald summation engine for madelung_ewald.jl.
+
+  Cell given by its metric tensor G (3x3, column-major), ions by their
+  fractional coordinates (3 x nat, column-major as `positions` in Julia)
+  and charges. The split parameter and the cutoffs are chosen by the
+  caller (cutoffs_r and cutoffs_h in madelung_ewald.jl).
+*/
+# ifndef EWALD_H
+# define EWALD_H
+
+# include <stddef.h>
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/* Errors */
+# define EWALD_EINVAL  -1
+# define EWALD_ENOMEM  -2
+
+/*
+  Scratch memory of the kernels: a bump (arena) allocator that keeps its
+  blocks between calls, so that repeated calls of the same size do no
+  malloc/free at all. A kernel given a workspace takes its temporaries from
+  it and gives them back on return; one workspace must not be used by two
+  calls at the same time. Kernels given NULL use one thread-local
+  workspace per calling thread.
+
+  ewald_workspace_new reserves BYTES up front (0: grow on first use) and
+  returns NULL if out of memory. ewald_workspace_reset releases all the
+  scratch, merging the blocks into one that fits the largest use so far.
+  ewald_workspace_mallocs counts the blocks allocated in its lifetime.
+*/
+typedef struct ewald_workspace ewald_workspace;
+
+ewald_workspace *ewald_workspace_new ( size_t bytes );
+void ewald_workspace_free ( ewald_workspace *ws );
+void ewald_workspace_reset ( ewald_workspace *ws );
+size_t ewald_workspace_capacity ( const ewald_workspace *ws );
+long ewald_workspace_mallocs ( const ewald_workspace *ws );
+
+/*
+  Real-space sum 1/2 sum_ij sum'_R q_i q_j erfc(alpha r)/r over the lattice
+  vectors |R_k| <= rmax[k] and r < rcut, and reciprocal-space sum
+  2pi/V sum_{h != 0} |S(h)|^2 exp(-(h/2alpha)^2)/h^2 over |K_k| <= kmax[k]
+  and h < hcut, with the structure factor S(h) = sum_i q_i exp(-i h.r_i).
+  Both are spread over NTHREADS OpenMP threads (0: the default).
+  Returns 0, EWALD_EINVAL for bad arguments or EWALD_ENOMEM.
+*/
+int ewald_sums ( int nat, const double *G, const double *positions,
+                 const double *q, double alpha, double rcut, const int *rmax,
+                 double hcut, const int *kmax, int nthreads,
+                 double *real, double *recip );
+
+/* Same as ewald_sums, with scratch memory from WS (or NULL) */
+int ewald_sums_ws ( ewald_workspace *ws, int nat, const double *G,
+                    const double *positions, const double *q, double alpha,
+                    double rcut, const int *rmax, double hcut,
+                    const int *kmax, int nthreads,
+                    double *real, double *recip );
+
+# ifdef __cplusplus
+}
+# endif
+
+# endif
@@ -6,6 +6,7 @@
 using Formatting: printfmt
 using SpecialFunctions
 using LinearAlgebra
+using .McMurchieDavidson: twoe_iterator
 
 abstract type BasisFunction end
 
@@ -19,11 +20,15 @@ end
 
 #Slater Type Orbital fit with N primative gausians (STO-NG) type basis
 struct STONG <: BasisFunction
-    n::Integer
+    n::Int
     #contraction coeffiecents
-    d::Array{Float64} 
+    d::Vector{Float64}
     #primative gaussians
-    g::Array{Gaussian1s}
+    g::Vector{Gaussian1s}
+    #their exponents and (common) center, contiguous for the contraction kernels
+    α::Vector{Float64}
+    center::Float64
+    STONG(n, d, g) = new(n, d, g, [gᵢ.α for gᵢ in g], first(g).center)
 end
 
 #STO-3G basis for hydrogen
@@ -46,133 +51,177 @@ function sto3g(center, ζ)
              Gaussian1s(scaling*2.22766, center)])
 end
 
+#Closed-form integrals over normalized 1s Gaussians with exponents α, β, ...
+#at Ra, Rb, ..., written on plain numbers so that the contractions below can
+#run them over the contiguous exponents of whole STONG functions.
+
+#normalization constant of a primitive pair
+@inline _norm2(α, β) = (2α/π)^(3/4) * (2β/π)^(3/4)
+
+#0.5sqrt(π/t) * erf(sqrt(t)), → 1 for t → 0
+@inline _f0(t) = abs(t) < 1e-8 ? 1.0 : 0.5sqrt(π/t) * erf(sqrt(t))
+
+@inline function overlap_primitive(α, β, Ra, Rb)
+    _norm2(α, β) * (π/(α+β))^(3/2) * exp(-α*β/(α+β) * abs(Ra-Rb)^2)
+end
+
+@inline function kinetic_primitive(α, β, Ra, Rb)
+    μ = α*β/(α+β)
+    _norm2(α, β) * μ * (3-2μ*abs(Ra-Rb)^2) * (π/(α+β))^(3/2) * exp(-μ*abs(Ra-Rb)^2)
+end
+
+@inline function nuclear_attraction_primitive(Zc, Rc, α, β, Ra, Rb)
+    Rp = (α*Ra + β*Rb)/(α + β)
+    matrix_element  = _norm2(α, β)*-2π/(α+β)*Zc
+    matrix_element *= exp(-α*β/(α+β)*abs(Ra-Rb)^2)
+    matrix_element * _f0((α+β)*abs(Rp-Rc)^2)
+end
+
+@inline function two_electron_primitive(α, β, γ, δ, Ra, Rb, Rc, Rd)
+    Rp = (α*Ra + β*Rb)/(α + β)
+    Rq = (γ*Rc + δ*Rd)/(γ + δ)
+    matrix_element  = 2*_norm2(α, β)*_norm2(γ, δ)*π^(5/2)
+    matrix_element /= ((α+β)*(γ+δ)*sqrt(α+β+γ+δ))
+    matrix_element *= exp(-α*β/(α+β)*abs(Ra-Rb)^2 - γ*δ/(γ+δ)*abs(Rc-Rd)^2)
+    matrix_element * _f0((α+β)*(γ+δ)/(α+β+γ+δ)*abs(Rp-Rq)^2)
+end
+
 #The overlap integrals describe how the basis functions overlap
 #as the atom centered gaussian basis functions are non-orthognal
 #they have a non-zero overlap. The integral has the following form:
 #S_{ij} = ∫ ϕ_i(r-R_a) ϕ_j(r-R_b) \mathrm{d}r
 function overlap_integral(b1::STONG, b2::STONG)
-    two_center_contraction(b1, b2, overlap_integral)
+    two_center_contraction(b1, b2, overlap_primitive)
 end
 
 #This function calculates the overlap integral for 1s Gaussian
 #orbitals using a closed-form expression.
 function overlap_integral(g1::Gaussian1s, g2::Gaussian1s)
-    α = g1.α
-    β = g2.α
-    Ra = g1.center
-    Rb = g2.center
-
-    #normalization constant
-    n = (2α/π)^(3/4) * (2β/π)^(3/4)
-
-    S  = n * (π/(α+β))^(3/2) 
-    S *= exp(-α*β/(α+β) * abs(Ra-Rb)^2)
-
-    return S
+    overlap_primitive(g1.α, g2.α, g1.center, g2.center)
 end
 
 #
 function nuclear_attraction_integral(Zc::Int, Rc::Float64, b1::STONG, 
                                      b2::STONG)
-    integral(g1, g2) = nuclear_attraction_integral(Zc, Rc, g1, g2)
-    two_center_contraction(b1, b2, integral)
+    kernel(α, β, Ra, Rb) = nuclear_attraction_primitive(Zc, Rc, α, β, Ra, Rb)
+    two_center_contraction(b1, b2, kernel)
 end
 
 function nuclear_attraction_integral(Zc::Int, Rc::Float64, g1::Gaussian1s, g2::Gaussian1s)
-    α = g1.α
-    β  = g2.α
-    Ra = g1.center
-    Rb = g2.center
-    Rp = (α*Ra + β*Rb)/(α + β)
-
-    n = (2α/π)^(3/4) * (2β/π)^(3/4)
-    matrix_element  = n*-2π/(α+β)*Zc
-    matrix_element *= exp(-α*β/(α+β)*abs(Ra-Rb)^2)
-
-    t = (α+β)*abs(Rp-Rc)^2
-    if abs(t) < 1e-8
-        return matrix_element
-    end
-
-    matrix_element *= 0.5sqrt(π/t) * erf(sqrt(t))
-    return matrix_element
+    nuclear_attraction_primitive(Zc, Rc, g1.α, g2.α, g1.center, g2.center)
 end
 
 function kinetic_energy_integral(b1::STONG, b2::STONG)
-    two_center_contraction(b1, b2, kinetic_energy_integral)
+    two_center_contraction(b1, b2, kinetic_primitive)
 end
 
 function kinetic_energy_integral(g1::Gaussian1s, g2::Gaussian1s)
-    α = g1.α
-    β = g2.α
-    Ra = g1.center
-    Rb = g2.center
-
-    n = (2α/π)^(3/4) * (2β/π)^(3/4)
-
-    matrix_element  = n * α*β/(α+β)
-    matrix_element *= (3-2α*β/((α+β)/abs(Ra-Rb)^2 )) 
-    matrix_element *= (π/(α+β))^(3/2)
-    matrix_element *= exp(-α*β/(α+β) * abs(Ra-Rb)^2)
+    kinetic_primitive(g1.α, g2.α, g1.center, g2.center)
 end
 
 function two_electron_integral(g1::STONG, g2::STONG, g3::STONG, g4::STONG)
-    four_center_contraction(g1, g2, g3, g4, two_electron_integral)
+    four_center_contraction(g1, g2, g3, g4, two_electron_primitive)
 end
 
 function two_electron_integral(g1::Gaussian1s, g2::Gaussian1s, g3::Gaussian1s, 
                                g4::Gaussian1s)
-    α  = g1.α
-    β  = g2.α
-    γ  = g3.α
-    δ  = g4.α
-    Ra = g1.center
-    Rb = g2.center
-    Rc = g3.center
-    Rd = g4.center
-    Rp = (α*Ra + β*Rb)/(α + β)
-    Rq = (γ*Rc + δ*Rd)/(γ + δ)
-
-    n  = (2α/π)^(3/4) * (2β/π)^(3/4)
-    n *= (2γ/π)^(3/4) * (2δ/π)^(3/4)
-
-    matrix_element  = 2n*π^(5/2)
-    matrix_element /= ((α+β)*(γ+δ)*sqrt(α+β+γ+δ))
-    matrix_element *= exp(-α*β/(α+β)*abs(Ra-Rb)^2 - γ*δ/(γ+δ)*abs(Rc-Rd)^2)
-    t = (α+β)*(γ+δ)/(α+β+γ+δ)*abs(Rp-Rq)^2
-    if abs(t) < 1e-8
-        return matrix_element
-    end
-
-    matrix_element *= 0.5sqrt(π/t) * erf(sqrt(t))
-    return matrix_element
+    two_electron_primitive(g1.α, g2.α, g3.α, g4.α,
+                           g1.center, g2.center, g3.center, g4.center)
 end
 
-function two_center_contraction(b1::STONG, b2::STONG, integral::Function)
+#Contractions over the primitives of whole STONG functions: `kernel` takes
+#exponents and centers, is specialized on (no dynamic dispatch in the loops)
+#and the innermost loop runs over contiguous exponents and coefficients.
+function two_center_contraction(b1::STONG, b2::STONG, kernel::F) where F
     total = 0.0
-    for p = 1:b1.n, q = 1:b2.n
-        d1 = b1.d[p]
-        d2 = b2.d[q]
-        total += d1*d2*integral(b1.g[p], b2.g[q]) 
+    Ra, Rb = b1.center, b2.center
+    @inbounds for q = 1:b2.n
+        β, d2 = b2.α[q], b2.d[q]
+        @simd for p = 1:b1.n
+            total += b1.d[p]*d2*kernel(b1.α[p], β, Ra, Rb)
+        end
     end
     return total
 end
 
 function four_center_contraction(b1::STONG, b2::STONG, b3::STONG, b4::STONG,
-                                 integral::Function)
+                                 kernel::F) where F
     total = 0.0
-    for p in 1:b1.n, q in 1:b2.n, r in 1:b3.n, s in 1:b4.n
-        dp = b1.d[p]
-        dq = b2.d[q]
-        dr = b3.d[r]
-        ds = b4.d[s]
-        total += dp*dq*dr*ds*integral(b1.g[p], b2.g[q], b3.g[r], b4.g[s])
+    Ra, Rb, Rc, Rd = b1.center, b2.center, b3.center, b4.center
+    @inbounds for s in 1:b4.n, r in 1:b3.n, q in 1:b2.n
+        β, γ, δ = b2.α[q], b3.α[r], b4.α[s]
+        dqrs = b2.d[q]*b3.d[r]*b4.d[s]
+        @simd for p in 1:b1.n
+            total += b1.d[p]*dqrs*kernel(b1.α[p], β, γ, δ, Ra, Rb, Rc, Rd)
+        end
     end
     total
- end
+end
 
+#Schwarz bounds Q_{μν} = √(μν|μν), so that |(μν|λσ)| ≤ Q_{μν} Q_{λσ}
+function schwarz_bounds(ϕ)
+    K = length(ϕ)
+    Q = zeros(K,K)
+    for μ = 1:K, ν = 1:μ
+        Q[μ,ν] = Q[ν,μ] = sqrt(abs(two_electron_integral(ϕ[μ], ϕ[ν], ϕ[μ], ϕ[ν])))
+    end
+    Q
+end
+
+#Two-electron part of the Fock matrix G(D) = J(D) - ½K(D), computed directly
+#from the unique integrals (twoe_iterator) instead of a stored K⁴ tensor.
+#Quartets whose contribution is bounded by `threshold` (Schwarz bound times
+#the largest density element they touch) are skipped, so for a small
+#density change ΔD most of them are.
+function direct_two_electron_fock(ϕ, D, Q, threshold)
+    K = length(ϕ)
+    J = zeros(K,K)
+    X = zeros(K,K) # exchange
+    for (i,j,k,l) in twoe_iterator(K)
+        dmax = max(abs(D[i,j]), abs(D[k,l]), abs(D[i,k]),
+                   abs(D[i,l]), abs(D[j,k]), abs(D[j,l]))
+        Q[i,j]*Q[k,l]*dmax < threshold && continue
+
+        v = two_electron_integral(ϕ[i], ϕ[j], ϕ[k], ϕ[l])
+        #weight of each of the 8 index permutations of (ij|kl)
+        i == j && (v *= 0.5)
+        k == l && (v *= 0.5)
+        (i,j) == (k,l) && (v *= 0.5)
+
+        J[i,j] += v*(D[k,l] + D[l,k])
+        J[j,i] += v*(D[k,l] + D[l,k])
+        J[k,l] += v*(D[i,j] + D[j,i])
+        J[l,k] += v*(D[i,j] + D[j,i])
+
+        X[i,k] += v*D[j,l]; X[j,k] += v*D[i,l]
+        X[i,l] += v*D[j,k]; X[j,l] += v*D[i,k]
+        X[k,i] += v*D[l,j]; X[l,i] += v*D[k,j]
+        X[k,j] += v*D[l,i]; X[l,j] += v*D[k,i]
+    end
+    J - 0.5X
+end
+
+#All two-electron integrals (μν|σλ) as a K×K×K×K tensor
+function two_electron_tensor(ϕ)
+    K = length(ϕ)
+    two_electron = zeros(K,K,K,K)
+    #for (μ, ν, λ, σ) in Iterators.product(1:K,1:K,1:K,1:K)
+    for μ in 1:K, ν in 1:K, λ in 1:K, σ in 1:K
+        coulomb  = two_electron_integral(ϕ[μ], ϕ[ν], ϕ[σ], ϕ[λ])
+        two_electron[μ,ν,σ,λ] = coulomb
+        exchange = two_electron_integral(ϕ[μ], ϕ[λ], ϕ[σ], ϕ[ν])
+        two_electron[μ,λ,σ,ν] = exchange
+    end
+    two_electron
+end
 
-function hartree_fock(R, Z)
+#With direct=true no two-electron integrals are stored: they are recomputed
+#every iteration and contracted with the change of density since the last
+#one (incremental Fock build, G(P) = G(P_old) + G(P - P_old)).
+#Otherwise, with a file name as cache, they are memory-mapped from that
+#binary cache (binary_cache.jl) if it was written for the same R and Z, and
+#computed and saved to it if not.
+function hartree_fock(R, Z; direct=false, threshold=1e-12, cache=nothing)
     #println("constructing basis set")
     #ϕ = Array(BasisFunction, length(Z))
     #ϕ = Array{BasisFunction}(length(Z))
@@ -231,13 +280,18 @@ function hartree_fock(R, Z)
 
     #calculate all of the two-electron integrals
     K = length(ϕ)
-    two_electron = zeros(K,K,K,K)
-    #for (μ, ν, λ, σ) in Iterators.product(1:K,1:K,1:K,1:K)
-    for μ in 1:K, ν in 1:K, λ in 1:K, σ in 1:K
-        coulomb  = two_electron_integral(ϕ[μ], ϕ[ν], ϕ[σ], ϕ[λ])
-        two_electron[μ,ν,σ,λ] = coulomb
-        exchange = two_electron_integral(ϕ[μ], ϕ[λ], ϕ[σ], ϕ[ν])
-        two_electron[μ,λ,σ,ν] = exchange
+    if direct
+        Q = schwarz_bounds(ϕ)
+        G = zeros(K,K)
+        P_old = zeros(K,K)
+    else
+        if cache === nothing
+            two_electron = two_electron_tensor(ϕ)
+        else
+            two_electron = cached(cache, key=Float64[R; Z]) do
+                ("two_electron" => two_electron_tensor(ϕ),)
+            end["two_electron"]
+        end
     end
 
     P = zeros(K,K)
@@ -249,13 +303,18 @@ function hartree_fock(R, Z)
     printfmt("{:4s} {:13s} ΔE\n", "iter", "total energy")
     for scf_iter = 1:100
         #calculate the two electron part of the Fock matrix
-        G = zeros(size(Hcore))
-        K = length(ϕ)
-
-        for μ = 1:K, ν = 1:K, λ = 1:K, σ = 1:K
-            coulomb  = two_electron[μ,ν,σ,λ]
-            exchange = two_electron[μ,λ,σ,ν]
-            G[μ,ν] += P[λ,σ]*(coulomb - 0.5exchange)
+        if direct
+            G += direct_two_electron_fock(ϕ, P - P_old, Q, threshold)
+            P_old = P
+        else
+            G = zeros(size(Hcore))
+            K = length(ϕ)
+
+            for μ = 1:K, ν = 1:K, λ = 1:K, σ = 1:K
+                coulomb  = two_electron[μ,ν,σ,λ]
+                exchange = two_electron[μ,λ,σ,ν]
+                G[μ,ν] += P[λ,σ]*(coulomb - 0.5exchange)
+            end
         end
 
         F = Hcore + G
@@ -11,9 +11,66 @@
 using Test
 using Printf
 using LinearAlgebra
+import Libdl
+import FFTW: rfft
 
 erfc(x::Float64) = @ccall erfc(x::Float64)::Float64
 
+# Native lattice sums (ewald/ewald.cpp), built by ewald/CMakeLists.txt (run
+# build.sh), or any other prebuilt copy given by SCIALGS_LIBEWALD
+const LIBEWALD_PREBUILT = get(ENV, "SCIALGS_LIBEWALD",
+                              joinpath(@__DIR__, "ewald", "build", "lib", "libewald." * Libdl.dlext))
+EWALDSOURCE = joinpath(@__DIR__, "ewald", "ewald.cpp")
+EWALDDEPS   = [EWALDSOURCE, joinpath(@__DIR__, "ewald", "ewald.h")]
+
+if isfile(LIBEWALD_PREBUILT)
+
+   const LIBEWALD = LIBEWALD_PREBUILT
+   if any(mtime(dep) > mtime(LIBEWALD) for dep in EWALDDEPS)
+      @warn "$LIBEWALD is older than its sources; rerun build.sh"
+   end
+else
+
+   const LIBEWALD = joinpath(@__DIR__, "ewald", "ewald.so")
+
+   if !isfile(LIBEWALD) || any(mtime(dep) > mtime(LIBEWALD) for dep in EWALDDEPS)
+      # Vector erfc/exp from libmvec, see CMakeLists.txt
+      run(`g++ -O3 -std=c++17 -ffast-math -fopenmp -shared -fPIC -o $LIBEWALD $EWALDSOURCE`)
+   end
+end
+
+"""
+    EwaldWorkspace(bytes=0)
+
+Scratch memory of LIBEWALD (see `ewald_workspace` in ewald/ewald.h), freed
+by a finalizer. Passed to `ewald(...; native=true, workspace)` it keeps the
+temporaries of the native sums between calls, so that repeated calls do no
+malloc/free. Not to be shared by concurrent calls; without one, every
+thread has its own.
+"""
+mutable struct EwaldWorkspace
+   ptr::Ptr{Cvoid}
+
+   function EwaldWorkspace(bytes::Integer = 0)
+      ptr = ccall((:ewald_workspace_new, LIBEWALD), Ptr{Cvoid}, (Csize_t,), bytes)
+      ptr == C_NULL && throw(OutOfMemoryError())
+      finalizer(new(ptr)) do ws
+         ccall((:ewald_workspace_free, LIBEWALD), Cvoid, (Ptr{Cvoid},), ws.ptr)
+      end
+   end
+end
+
+Base.unsafe_convert(::Type{Ptr{Cvoid}}, ws::EwaldWorkspace) = ws.ptr
+
+# Release the scratch of ws, merged into one block for the next calls
+reset!(ws::EwaldWorkspace) =
+   (ccall((:ewald_workspace_reset, LIBEWALD), Cvoid, (Ptr{Cvoid},), ws); ws)
+capacity(ws::EwaldWorkspace) =
+   Int(ccall((:ewald_workspace_capacity, LIBEWALD), Csize_t, (Ptr{Cvoid},), ws))
+# Blocks ever allocated by ws
+mallocs(ws::EwaldWorkspace) =
+   Int(ccall((:ewald_workspace_mallocs, LIBEWALD), Clong, (Ptr{Cvoid},), ws))
+
 function cutoffs_r(abc, αβγ, Nat, ∑Q², α, Ω, ϵ; SGROW = 1.4, EPSCUT = 1e-5)
 
    r_cut1 = 1
@@ -78,15 +135,28 @@ function cutoffs_h(abc, Nat, ∑Q², α, ϵ; SGROW = 1.4, EPSCUT = 1e-5)
 end
 
 @doc """
-    ewald(abc, αβγ, positions, Q, ϵ, α=missing)
+    ewald(abc, αβγ, positions, Q, ϵ, α=missing; native=false, nthreads=0,
+          workspace=nothing, pme=false, order=8, grid=missing)
 
 Compute the electrostatic sum of a distribution of point charges with
 Ewald's method. The unit cell is defined by the cell parameters, lengths `abc`
 and angles `αβγ`. Ion coordinates are given as columns of `positions`, and
 their charges are listed in `Q`. The parameter `ϵ` controls the admitted error
 and `α` is the short/long range split parameter.
+
+With `native=true` the real- and reciprocal-space sums, for the same cutoffs,
+are done by LIBEWALD: vectorised erfc/exp, structure factors from per-axis
+phase tables and `nthreads` threads (0: OpenMP default). Their scratch
+memory comes from `workspace`, an `EwaldWorkspace`, if given.
+
+With `pme=true` the reciprocal-space sum is done by smooth particle mesh
+Ewald instead: charges spread with B-splines of even `order` on a
+`grid` (by default ~4× the direct-sum reciprocal cutoff along each axis),
+O(N log N) with FFTs. The real-space sum is unchanged.
 """
-function ewald(abc, αβγ, positions, Q, ϵ=10^(log10(eps(Float64))+4), α=missing)
+function ewald(abc, αβγ, positions, Q, ϵ=10^(log10(eps(Float64))+4), α=missing;
+               native=false, nthreads=0, workspace=nothing, pme=false, order=8,
+               grid=missing)
 
    @assert size(abc) == (3,)      "abc has to be a column vector"
    @assert size(αβγ) == (3,)      "αβγ has to be a column vector"
@@ -116,6 +186,34 @@ function ewald(abc, αβγ, positions, Q, ϵ=10^(log10(eps(Float64))+4), α=miss
    r_cut, Rmax = cutoffs_r(abc, αβγ, Nat, ∑Q², α, Ω, ϵ)
    h_cut, Kmax = cutoffs_h(abc,      Nat, ∑Q², α,    ϵ)
 
+   # with PME only the real-space sum (no 𝐊 ≠ 0 within Kmax = 0)
+   Kₛ = pme ? zeros(3) : Kmax
+   if native
+      ∑Eᵣ, ∑Eₖ = ewald_sums_native(G, positions, Q, α, r_cut, Rmax, h_cut, Kₛ, nthreads,
+                                    workspace)
+   else
+      ∑Eᵣ, ∑Eₖ = ewald_sums(G, Ginv, Ω, positions, Q, α, r_cut, Rmax, h_cut, Kₛ)
+   end
+   if pme
+      grid = ismissing(grid) ? nextprod.(Ref([2, 3, 5]), 4 .* Int.(Kmax)) : grid
+      ∑Eₖ = pme_sum(Ginv, Ω, positions, Q, α, grid, order)
+   end
+
+   # 𝐤 = 0, self-energy term
+   ∑₀ = - α * ∑Q² / √π
+   #@printf("∑₀ = %.15f\n",∑₀)
+
+   # compensating background charge term for charge neutrality
+   ∑E_back = - 0.5π * ∑Q^2 / α^2 / Ω
+
+   ∑Eₖ + ∑Eᵣ + ∑₀ + ∑E_back
+end
+
+# Real- and reciprocal-space sums of ewald()
+function ewald_sums(G, Ginv, Ω, positions, Q, α, r_cut, Rmax, h_cut, Kmax)
+
+   Nat = length(Q)
+
    # Real-space sum
    ∑Eᵣ = 0
    for i in 1:Nat,
@@ -164,14 +262,105 @@ function ewald(abc, αβγ, positions, Q, ϵ=10^(log10(eps(Float64))+4), α=miss
    ∑Eₖ *= 2π / Ω
    #@printf("∑Eₖ = %.15f\n",∑Eₖ)
 
-   # 𝐤 = 0, self-energy term
-   ∑₀ = - α * ∑Q² / √π
-   #@printf("∑₀ = %.15f\n",∑₀)
+   ∑Eᵣ, ∑Eₖ
+end
 
-   # compensating background charge term for charge neutrality
-   ∑E_back = - 0.5π * ∑Q^2 / α^2 / Ω
+# Same sums by LIBEWALD
+function ewald_sums_native(G, positions, Q, α, r_cut, Rmax, h_cut, Kmax, nthreads=0,
+                           workspace=nothing)
 
-   ∑Eₖ + ∑Eᵣ + ∑₀ + ∑E_back
+   Nat = length(Q)
+   # contiguous 3×Nat, also for adjoints and a single ion given as a vector
+   r = Float64[positions[k, i] for k in 1:3, i in 1:Nat]
+   ∑Eᵣ = Ref{Float64}(0)
+   ∑Eₖ = Ref{Float64}(0)
+
+   ws = something(workspace, C_NULL)
+
+   status = GC.@preserve ws @ccall LIBEWALD.ewald_sums_ws(
+      ws                :: Ptr{Cvoid},
+      Nat               :: Cint,
+      Matrix{Float64}(G):: Ptr{Float64},
+      r                 :: Ptr{Float64},
+      Float64.(Q)       :: Ptr{Float64},
+      α                 :: Float64,
+      r_cut             :: Float64,
+      Cint.(Rmax)       :: Ptr{Cint},
+      h_cut             :: Float64,
+      Cint.(Kmax)       :: Ptr{Cint},
+      nthreads          :: Cint,
+      ∑Eᵣ               :: Ref{Float64},
+      ∑Eₖ               :: Ref{Float64}
+   )::Cint
+   status == 0 || error("ewald_sums failed ($status)")
+
+   ∑Eᵣ[], ∑Eₖ[]
+end
+
+# Weights M_n(x + j), j = 0,...,n-1, of the cardinal B-spline of order n
+# for 0 ≤ x < 1 (Essmann et al. (4.1)), i.e. of the grid points ⌊u⌋ - j of
+# a particle at grid coordinate u = ⌊u⌋ + x
+function bspline_weights!(w, x, n)
+   fill!(w, 0)
+   w[1] = x
+   w[2] = 1 - x
+   for k in 3:n
+      # M_k(y) = (y M_{k-1}(y) + (k-y) M_{k-1}(y-1)) / (k-1), top down in place
+      for j in k:-1:1
+         w[j] = ((x+j-1)*w[j] + (k-x-j+1)*(j > 1 ? w[j-1] : 0.0)) / (k-1)
+      end
+   end
+   w
+end
+
+# Reciprocal-space sum by smooth particle mesh Ewald:
+# U. Essmann et al., J. Chem. Phys. 103, 8577 (1995)
+#   ∑Eₖ = 1/(2πΩ) ∑_(𝐦≠0) exp(-π²|𝐦|²/α²)/|𝐦|² B(𝐦) |F(Q)(𝐦)|²
+# with the charges Q spread on a grid of K₁×K₂×K₃ points
+function pme_sum(Ginv, Ω, positions, Q, α, grid, order)
+
+   @assert iseven(order) "B-spline order has to be even"
+   K = Int.(grid)
+   Nat = length(Q)
+
+   # Charge mesh (Essmann (4.6))
+   mesh = zeros(K...)
+   w = [zeros(order) for _ in 1:3]
+   base = zeros(Int, 3)
+   for i in 1:Nat
+      for k in 1:3
+         u = K[k] * positions[k, i]
+         base[k] = floor(Int, u)
+         bspline_weights!(w[k], u - base[k], order)
+      end
+      for j3 in 1:order, j2 in 1:order
+         k2 = mod(base[2] - j2 + 1, K[2]) + 1
+         k3 = mod(base[3] - j3 + 1, K[3]) + 1
+         w23 = Q[i] * w[2][j2] * w[3][j3]
+         for j1 in 1:order
+            mesh[mod(base[1] - j1 + 1, K[1]) + 1, k2, k3] += w23 * w[1][j1]
+         end
+      end
+   end
+
+   # B(𝐦) = ∏ₖ |bₖ(mₖ)|² (Essmann (4.4)), from M[j+1] = M_n(j)
+   M = bspline_weights!(zeros(order), 0.0, order)
+   B = [[1 / abs2(sum(M[j+2] * cis(2π*m*j/K[k]) for j in 0:order-2)) for m in 0:K[k]-1]
+        for k in 1:3]
+
+   # |F(Q)(𝐦)|² = |F(Q)(-𝐦)|²: half of 𝐦₁ from the real FFT, counted twice
+   F = rfft(mesh)
+   ∑Eₖ = 0.0
+   for m3 in 0:K[3]-1, m2 in 0:K[2]-1, m1 in 0:size(F, 1)-1
+      (m1, m2, m3) == (0, 0, 0) && continue
+      # aliased to -K/2 < m ≤ K/2
+      m = [m1, m2 ≤ K[2]÷2 ? m2 : m2 - K[2], m3 ≤ K[3]÷2 ? m3 : m3 - K[3]]
+      m² = m'Ginv*m
+      twice = (m1 == 0 || 2m1 == K[1]) ? 1 : 2
+      ∑Eₖ += twice * exp(-π^2*m²/α^2) / m² *
+             B[1][m1+1] * B[2][m2+1] * B[3][m3+1] * abs2(F[m1+1, m2+1, m3+1])
+   end
+   ∑Eₖ / (2π*Ω)
 end
 
 # Testing
@@ -464,3 +653,63 @@ end
    @test E ≈ -244.055008450 # from Table I
 end
 
+
+@testset "Ewald: native lattice sums" begin
+
+   # NaCl, hex. BN and one ion (Al fcc): same energy as the Julia sums
+   cells = [([2, 2, 2], [90, 90, 90],
+             [0 0.5 0.5; 0.5 0 0.5; 0.5 0.5 0; 0 0 0;
+              0.5 0.5 0.5; 0.5 0 0; 0 0.5 0; 0 0 0.5]', [1, 1, 1, 1, -1, -1, -1, -1]),
+            ([4.7325, 4.7325, 12.5834], [90, 90, 120],
+             [0.33333 0.66667 0.25; 0.66667 0.33333 0.75;
+              0.33333 0.66667 0.75; 0.66667 0.33333 0.25]', [1.0, 1.0, -1.0, -1.0] .* 2.214),
+            ([2.8636, 2.8636, 2.8636] .|> angs2bohr, [60.0, 60.0, 60.0], zeros(3), [3.0])]
+
+   for (abc, αβγ, positions, Q) in cells
+      E = ewald(abc, deg2rad.(αβγ), positions, Q)
+      @test ewald(abc, deg2rad.(αβγ), positions, Q, native=true) ≈ E rtol=1e-12
+      @test ewald(abc, deg2rad.(αβγ), positions, Q, native=true, nthreads=1) ≈ E rtol=1e-12
+   end
+
+   # one workspace for all calls: grows once, then no more blocks
+   ws = EwaldWorkspace()
+   abc, αβγ, positions, Q = cells[2]
+   E = ewald(abc, deg2rad.(αβγ), positions, Q, native=true, workspace=ws)
+   n = mallocs(ws)
+   @test capacity(ws) > 0
+   for _ in 1:3
+      @test ewald(abc, deg2rad.(αβγ), positions, Q, native=true, workspace=ws) ≈ E rtol=1e-12
+   end
+   @test mallocs(ws) == n
+   abc, αβγ, positions, Q = cells[1]
+   @test ewald(abc, deg2rad.(αβγ), positions, Q, native=true, workspace=reset!(ws)) ≈
+         ewald(abc, deg2rad.(αβγ), positions, Q) rtol=1e-12
+end
+
+@testset "Ewald: smooth particle mesh" begin
+
+   # SiO₂ (ICSD:29122) and the cells above: PME vs direct reciprocal sum
+   SiO₂ = ([4.9130, 4.9130, 5.4050] .|> angs2bohr, [90.0, 90.0, 120.0],
+           [0.41500 0.27200 0.21300; 0.72800 0.14300 0.54633; 0.85700 0.58500 0.87967;
+            0.27200 0.41500 0.78700; 0.14300 0.72800 0.45367; 0.58500 0.85700 0.12033;
+            0.46500 0.00000 0.33333; 0.00000 0.46500 0.66667; 0.53500 0.53500 0.00000]',
+           vcat(repeat([6.0], 6), repeat([4.0], 3)))
+   cells = [([2, 2, 2], [90, 90, 90],
+             [0 0.5 0.5; 0.5 0 0.5; 0.5 0.5 0; 0 0 0;
+              0.5 0.5 0.5; 0.5 0 0; 0 0.5 0; 0 0 0.5]', [1, 1, 1, 1, -1, -1, -1, -1]),
+            ([√2/2, √2/2, √2/2], [60, 60, 60], [0 0 0; 0.25 0.25 0.25]', [1, -1]),
+            SiO₂]
+
+   for (abc, αβγ, positions, Q) in cells
+      E = ewald(abc, deg2rad.(αβγ), positions, Q)
+      @test ewald(abc, deg2rad.(αβγ), positions, Q, pme=true) ≈ E rtol=1e-9
+      @test ewald(abc, deg2rad.(αβγ), positions, Q, pme=true, native=true) ≈ E rtol=1e-9
+   end
+
+   # converges with the B-spline order on a fixed grid
+   abc, αβγ, positions, Q = SiO₂
+   E = ewald(abc, deg2rad.(αβγ), positions, Q)
+   errors = [abs(ewald(abc, deg2rad.(αβγ), positions, Q, pme=true, order=n, grid=[24, 24, 24]) - E)
+             for n in (4, 6, 8)]
+   @test issorted(errors, rev=true)
+end
@@ -0,0 +1,150 @@
+#include <cmath>
+#include <vector>
+
+#include "boys.hpp"
+
+namespace mmd
+{
+
+namespace
+{
+
+// Grid F_n(kΔ) for n ≤ BOYS_NMAX + TAYLOR and kΔ ≤ TMAX + Δ. Beyond TMAX
+// the upward recursion from F_0 of boys_reference is exact and stable.
+constexpr int TAYLOR = 7;                    // |T - kΔ| ≤ Δ/2: error < 1e-15
+constexpr double DELTA = 0.1;
+constexpr double INV_DELTA = 10.0;
+constexpr double TMAX = 35.0 + BOYS_NMAX;
+constexpr int COLS = BOYS_NMAX + TAYLOR + 1;
+constexpr int ROWS = int(TMAX*INV_DELTA) + 2;
+
+// 1/j for the Taylor series and 1/(2m+1) for the downward recursion
+struct Reciprocals
+{
+  double j[TAYLOR + 1];
+  double odd[BOYS_NMAX + 1];
+  constexpr Reciprocals() : j(), odd()
+  {
+    for (int i = 1; i <= TAYLOR; i++) j[i] = 1.0/i;
+    for (int m = 0; m <= BOYS_NMAX; m++) odd[m] = 1.0/(2*m + 1);
+  }
+};
+constexpr Reciprocals inv;
+
+const double* grid()
+{
+  static const std::vector<double> table = [] {
+    std::vector<double> t(size_t(ROWS)*COLS);
+    for (int k = 0; k < ROWS; k++)
+    {
+      boys_reference(COLS - 1, k*DELTA, &t[size_t(k)*COLS]);
+    }
+    return t;
+  }();
+  return table.data();
+}
+
+} // namespace
+
+// For large T, F_0 = ½√(π/T) erf(√T) with erf(√T) = 1 to double precision
+// and upward recursion, stable for T > n. Otherwise F_nmax from its series
+// and downward recursion, stable for all T (HJO §9.8).
+void boys_reference(int nmax, double T, double* F)
+{
+  const double expT = std::exp(-T);
+
+  if (T > 35.0 + nmax)
+  {
+    F[0] = 0.5*std::sqrt(M_PI/T);
+    for (int n = 1; n <= nmax; n++)
+    {
+      F[n] = ((2*n - 1)*F[n - 1] - expT)/(2.0*T);
+    }
+    return;
+  }
+
+  // exp(-T) Σ_k (2T)^k/((2n+1)(2n+3)...(2n+2k+1)), positive terms only
+  double term = 1.0/(2*nmax + 1);
+  double sum = term;
+  for (int k = 1; term > 1e-17*sum; k++)
+  {
+    term *= 2.0*T/(2*nmax + 2*k + 1);
+    sum += term;
+  }
+  F[nmax] = expT*sum;
+  for (int n = nmax - 1; n >= 0; n--)
+  {
+    F[n] = (2.0*T*F[n + 1] + expT)/(2*n + 1);
+  }
+}
+
+void boys_batch(int nmax, long npts, const double* T, double* F)
+{
+  if (nmax > BOYS_NMAX)
+  {
+    std::vector<double> Fi(nmax + 1);
+    for (long i = 0; i < npts; i++)
+    {
+      boys_reference(nmax, T[i], Fi.data());
+      for (int m = 0; m <= nmax; m++)
+      {
+        F[m*npts + i] = Fi[m];
+      }
+    }
+    return;
+  }
+
+  const double* table = grid();
+
+  // F_nmax(T) = Σ_j F_{nmax+j}(kΔ) (kΔ - T)^j/j!, since dF_n/dT = -F_{n+1},
+  // then downward recursion
+#pragma omp simd
+  for (long i = 0; i < npts; i++)
+  {
+    const double t = T[i];
+    const double tc = t < TMAX ? t : TMAX;
+    const long k = long(tc*INV_DELTA + 0.5);
+    const double dt = k*DELTA - tc;
+    const double* row = table + k*COLS + nmax;
+
+    double f = row[TAYLOR];
+    for (int j = TAYLOR; j > 0; j--)
+    {
+      f = row[j - 1] + f*dt*inv.j[j];
+    }
+    F[nmax*npts + i] = f;
+
+    const double expT = std::exp(-t);
+    for (int m = nmax - 1; m >= 0; m--)
+    {
+      f = (2.0*t*f + expT)*inv.odd[m];
+      F[m*npts + i] = f;
+    }
+  }
+
+  // Large T: overwritten by the upward recursion
+#pragma omp simd
+  for (long i = 0; i < npts; i++)
+  {
+    const double t = T[i];
+    if (t > TMAX)
+    {
+      const double expT = std::exp(-t);
+      const double inv2t = 0.5/t;
+      double f = 0.5*std::sqrt(M_PI/t);
+      F[i] = f;
+      for (int m = 1; m <= nmax; m++)
+      {
+        f = ((2*m - 1)*f - expT)*inv2t;
+        F[m*npts + i] = f;
+      }
+    }
+  }
+}
+
+void boys(int nmax, double T, double* F)
+{
+  boys_batch(nmax, 1, &T, F);
+}
+
+} // namespace mmd
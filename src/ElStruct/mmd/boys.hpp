@@ -0,0 +1,26 @@
+// Boys function F_n(T) = ∫₀¹ t²ⁿ exp(-T t²) dt (HJO §9.8)
+
+#ifndef MMD_BOYS_HPP
+#define MMD_BOYS_HPP
+
+namespace mmd
+{
+
+// Largest order served from the precomputed grid; higher orders fall back
+// to boys_reference
+constexpr int BOYS_NMAX = 24;
+
+// F_0(T), ..., F_nmax(T) into F[0..nmax]: Taylor interpolation of F_nmax on
+// a precomputed grid and downward recursion
+void boys(int nmax, double T, double* F);
+
+// Batched boys for npts values of T: F_m(T[i]) goes to F[m*npts + i], i.e.
+// a column-major npts × (nmax+1) matrix. Vectorised over the points.
+void boys_batch(int nmax, long npts, const double* T, double* F);
+
+// Series/asymptotic evaluation used to build the grid, slow but accurate
+void boys_reference(int nmax, double T, double* F);
+
+} // namespace mmd
+
+#endif
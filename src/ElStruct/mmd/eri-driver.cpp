@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "eri-driver.hpp"
+
+namespace mmd
+{
+
+namespace
+{
+
+// A run of ket pairs [kl_begin, kl_end) of one bra pair
+struct Task
+{
+  long ij, kl_begin, kl_end;
+};
+
+// Quartets per task: small enough to balance, large enough to amortise the
+// queue locking
+constexpr long TASK_QUARTETS = 32;
+
+// Per-thread deque: the owner pops from the front, thieves steal from the
+// back. Tasks are never added once the workers start, so a thread that
+// finds every queue empty is done.
+class WorkQueue
+{
+public:
+  void push(const Task& t)
+  {
+    tasks_.push_back(t);
+  }
+
+  bool pop(Task& t)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) return false;
+    t = tasks_.front();
+    tasks_.pop_front();
+    return true;
+  }
+
+  bool steal(Task& t)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) return false;
+    t = tasks_.back();
+    tasks_.pop_back();
+    return true;
+  }
+
+private:
+  std::mutex mutex_;
+  std::deque<Task> tasks_;
+};
+
+} // namespace
+
+std::vector<double> schwarz_bounds(const std::vector<ShellPair>& pairs)
+{
+  std::vector<double> Q(pairs.size());
+  for (size_t ij = 0; ij < pairs.size(); ij++)
+  {
+    Q[ij] = std::sqrt(std::fabs(electron_repulsion(pairs[ij], pairs[ij])));
+  }
+  return Q;
+}
+
+std::vector<double> electron_repulsion_unique(const std::vector<BasisFunction>& basis,
+                                              double threshold, int nthreads,
+                                              EriStats* stats)
+{
+  const long nbasis = long(basis.size());
+  const long npairs = nbasis*(nbasis + 1)/2;
+
+  // Hermite tables of every pair, shared read-only by all threads
+  std::vector<ShellPair> pairs;
+  pairs.reserve(npairs);
+  for (long i = 0; i < nbasis; i++)
+  {
+    for (long j = 0; j <= i; j++)
+    {
+      pairs.emplace_back(basis[i], basis[j]);   // at pair_index(i, j)
+    }
+  }
+  const std::vector<double> Q = schwarz_bounds(pairs);
+
+  if (nthreads <= 0)
+  {
+    nthreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<WorkQueue> queues(nthreads);
+  long ntasks = 0;
+  for (long ij = 0; ij < npairs; ij++)
+  {
+    for (long kl = 0; kl <= ij; kl += TASK_QUARTETS)
+    {
+      queues[ntasks++ % nthreads].push({ij, kl, std::min(kl + TASK_QUARTETS, ij + 1)});
+    }
+  }
+
+  std::vector<double> eri(npairs*(npairs + 1)/2, 0.0);
+  std::vector<EriStats> counts(nthreads);
+
+  auto worker = [&](int id) {
+    EriStats count;
+    Task task;
+    for (;;)
+    {
+      bool found = queues[id].pop(task);
+      for (int k = 1; !found && k < nthreads; k++)
+      {
+        found = queues[(id + k) % nthreads].steal(task);
+      }
+      if (!found) break;
+
+      const double Qij = Q[task.ij];
+      for (long kl = task.kl_begin; kl < task.kl_end; kl++)
+      {
+        if (Qij*Q[kl] < threshold)
+        {
+          count.screened++;
+          continue;
+        }
+        eri[pair_index(task.ij, kl)] = electron_repulsion(pairs[task.ij], pairs[kl]);
+        count.computed++;
+      }
+    }
+    counts[id] = count;
+  };
+
+  std::vector<std::thread> threads;
+  for (int id = 1; id < nthreads; id++)
+  {
+    threads.emplace_back(worker, id);
+  }
+  worker(0);
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+
+  if (stats)
+  {
+    *stats = EriStats();
+    for (const auto& c : counts)
+    {
+      stats->computed += c.computed;
+      stats->screened += c.screened;
+    }
+  }
+  return eri;
+}
+
+} // namespace mmd
@@ -0,0 +1,48 @@
+// Screened two-electron integrals over a whole basis, the native counterpart
+// of looping ERI over twoe_iterator in McMurchieDavidson.jl.
+
+#ifndef MMD_ERI_DRIVER_HPP
+#define MMD_ERI_DRIVER_HPP
+
+#include <vector>
+
+#include "mcmurchie-davidson.hpp"
+
+namespace mmd
+{
+
+// Compound index of the pair (i, j), symmetric in i and j (0-based)
+inline long pair_index(long i, long j)
+{
+  return i >= j ? i*(i + 1)/2 + j : j*(j + 1)/2 + i;
+}
+
+// Position of (ij|kl) among the 8-fold unique integrals, i.e. the quartets
+// i ≥ j, k ≥ l, ij ≥ kl of twoe_iterator
+inline long eri_index(long i, long j, long k, long l)
+{
+  return pair_index(pair_index(i, j), pair_index(k, l));
+}
+
+struct EriStats
+{
+  long computed = 0;
+  long screened = 0;
+};
+
+// Schwarz bounds Q_ij = √|(ij|ij)| of every pair, at pair_index(i, j)
+std::vector<double> schwarz_bounds(const std::vector<ShellPair>& pairs);
+
+// All unique (ij|kl), at eri_index(i, j, k, l). Quartets with
+// Q_ij Q_kl < threshold, an upper bound of |(ij|kl)|, are skipped and left
+// as 0. The surviving ones are computed by `nthreads` threads (0: all
+// cores) that steal work from each other, since a quartet's cost varies
+// wildly with its angular momenta and contraction lengths.
+std::vector<double> electron_repulsion_unique(const std::vector<BasisFunction>& basis,
+                                              double threshold = 1e-12,
+                                              int nthreads = 0,
+                                              EriStats* stats = nullptr);
+
+} // namespace mmd
+
+#endif
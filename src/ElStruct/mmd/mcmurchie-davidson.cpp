@@ -0,0 +1,297 @@
+#include <cmath>
+
+#include "boys.hpp"
+#include "mcmurchie-davidson.hpp"
+
+namespace mmd
+{
+
+HermiteE::HermiteE(int imax, int jmax, double Qx, double a, double b)
+  : jmax_(jmax), tdim_(imax + jmax + 1),
+    data_((imax + 1)*(jmax + 1)*(imax + jmax + 1), 0.0)
+{
+  // §9.5.1; Note: Xpa = μ*Qx/a; Xpb = μ*Qx/b
+  const double p = a + b;    // (9.2.10)
+  const double mu = a*b/p;   // (9.2.12)
+  const double Xpa = -mu*Qx/a;
+  const double Xpb = mu*Qx/b;
+  auto at = [this](int i, int j, int t) -> double& {
+    return data_[(i*(jmax_ + 1) + j)*tdim_ + t];
+  };
+  // E^{ij}_t for t outside [0, i+j] vanishes (9.5.5)
+  auto get = [&](int i, int j, int t) {
+    return (t < 0 || t > i + j) ? 0.0 : at(i, j, t);
+  };
+
+  at(0, 0, 0) = std::exp(-mu*Qx*Qx);   // (9.5.8) → (9.2.15)
+  for (int i = 0; i <= imax; i++)
+  {
+    if (i > 0)
+    {
+      for (int t = 0; t <= i; t++)   // (9.5.6)
+      {
+        at(i, 0, t) = get(i-1, 0, t-1)/(2*p) + get(i-1, 0, t)*Xpa +
+                      get(i-1, 0, t+1)*(t+1);
+      }
+    }
+    for (int j = 1; j <= jmax; j++)
+    {
+      for (int t = 0; t <= i + j; t++)   // (9.5.7)
+      {
+        at(i, j, t) = get(i, j-1, t-1)/(2*p) + get(i, j-1, t)*Xpb +
+                      get(i, j-1, t+1)*(t+1);
+      }
+    }
+  }
+}
+
+void HermiteR::compute(int L, double p, const std::array<double,3>& PC)
+{
+  const double RPC2 = PC[0]*PC[0] + PC[1]*PC[1] + PC[2]*PC[2];
+  boys_.resize(L + 1);
+  boys(L, p*RPC2, boys_.data());
+  compute(L, p, PC, boys_.data(), 1);
+}
+
+void HermiteR::compute(int L, double p, const std::array<double,3>& PC,
+                       const double* F, long stride)
+{
+  // R^n_{tuv} for n + t + u + v ≤ L, stored as [n][t][u][v]
+  dim_ = L + 1;
+  const int dim = dim_;
+  data_.assign(static_cast<size_t>(dim)*dim*dim*dim, 0.0);
+  auto at = [&](int n, int t, int u, int v) -> double& {
+    return data_[((n*dim + t)*dim + u)*dim + v];
+  };
+
+  double factor = 1.0;
+  for (int n = 0; n <= L; n++)
+  {
+    at(n, 0, 0, 0) = factor*F[n*stride];   // (9.9.14)
+    factor *= -2.0*p;
+  }
+
+  for (int k = 1; k <= L; k++)          // k = t + u + v
+  {
+    for (int n = 0; n <= L - k; n++)
+    {
+      for (int t = k; t >= 0; t--)
+      {
+        for (int u = k - t; u >= 0; u--)
+        {
+          const int v = k - t - u;
+          double val;
+          if (t > 0)                     // (9.9.18)
+          {
+            val = PC[0]*at(n+1, t-1, u, v);
+            if (t > 1) val += (t-1)*at(n+1, t-2, u, v);
+          }
+          else if (u > 0)                // (9.9.19)
+          {
+            val = PC[1]*at(n+1, t, u-1, v);
+            if (u > 1) val += (u-1)*at(n+1, t, u-2, v);
+          }
+          else                           // (9.9.20)
+          {
+            val = PC[2]*at(n+1, t, u, v-1);
+            if (v > 1) val += (v-1)*at(n+1, t, u, v-2);
+          }
+          at(n, t, u, v) = val;
+        }
+      }
+    }
+  }
+}
+
+ShellPair::ShellPair(const BasisFunction& a, const BasisFunction& b, int jextra)
+  : la_(a.shell), lb_(b.shell)
+{
+  prims_.reserve(a.exps.size()*b.exps.size());
+  for (size_t i = 0; i < a.exps.size(); i++)
+  {
+    for (size_t j = 0; j < b.exps.size(); j++)
+    {
+      PrimitivePair pp;
+      pp.a = a.exps[i];
+      pp.b = b.exps[j];
+      pp.p = pp.a + pp.b;
+      for (int x = 0; x < 3; x++)
+      {
+        pp.P[x] = (pp.a*a.origin[x] + pp.b*b.origin[x])/pp.p;
+      }
+      pp.coef = a.norm[i]*b.norm[j]*a.coefs[i]*b.coefs[j];
+      pp.Ex = HermiteE(la_[0], lb_[0] + jextra, a.origin[0] - b.origin[0], pp.a, pp.b);
+      pp.Ey = HermiteE(la_[1], lb_[1] + jextra, a.origin[1] - b.origin[1], pp.a, pp.b);
+      pp.Ez = HermiteE(la_[2], lb_[2] + jextra, a.origin[2] - b.origin[2], pp.a, pp.b);
+      prims_.push_back(std::move(pp));
+    }
+  }
+}
+
+namespace
+{
+
+double primitive_overlap(const PrimitivePair& pp, const std::array<int,3>& la,
+                         int l2, int m2, int n2)
+{
+  return pp.Ex(la[0], l2, 0)*pp.Ey(la[1], m2, 0)*pp.Ez(la[2], n2, 0)*
+         std::pow(M_PI/pp.p, 1.5);   // (9.5.41)
+}
+
+} // namespace
+
+double overlap(const BasisFunction& a, const BasisFunction& b)
+{
+  const ShellPair ab(a, b);
+  const auto& lb = ab.lb();
+  double s = 0.0;
+  for (const auto& pp : ab.primitives())
+  {
+    s += pp.coef*primitive_overlap(pp, ab.la(), lb[0], lb[1], lb[2]);
+  }
+  return s;
+}
+
+double kinetic(const BasisFunction& a, const BasisFunction& b)
+{
+  const ShellPair ab(a, b, 2);
+  const auto& la = ab.la();
+  const int l2 = ab.lb()[0], m2 = ab.lb()[1], n2 = ab.lb()[2];
+  double t = 0.0;
+  for (const auto& pp : ab.primitives())
+  {
+    // (9.3.31) → (9.3.37) grouped by (i,j), (i+2,j), (i-2,j), as in kinetic()
+    const double b_ = pp.b;
+    double term1 = b_*(2*(l2 + m2 + n2) + 3)*primitive_overlap(pp, la, l2, m2, n2);
+    double term2 = -2*b_*b_*(primitive_overlap(pp, la, l2 + 2, m2, n2) +
+                             primitive_overlap(pp, la, l2, m2 + 2, n2) +
+                             primitive_overlap(pp, la, l2, m2, n2 + 2));
+    double term3 = 0.0;
+    if (l2 > 1) term3 += l2*(l2 - 1)*primitive_overlap(pp, la, l2 - 2, m2, n2);
+    if (m2 > 1) term3 += m2*(m2 - 1)*primitive_overlap(pp, la, l2, m2 - 2, n2);
+    if (n2 > 1) term3 += n2*(n2 - 1)*primitive_overlap(pp, la, l2, m2, n2 - 2);
+    t += pp.coef*(term1 + term2 - 0.5*term3);
+  }
+  return t;
+}
+
+double nuclear_attraction(const BasisFunction& a, const BasisFunction& b,
+                          const std::array<double,3>& C)
+{
+  const ShellPair ab(a, b);
+  const auto& la = ab.la();
+  const auto& lb = ab.lb();
+  HermiteR R;
+  double v = 0.0;
+  for (const auto& pp : ab.primitives())
+  {
+    const std::array<double,3> PC = {pp.P[0] - C[0], pp.P[1] - C[1], pp.P[2] - C[2]};
+    R.compute(ab.L(), pp.p, PC);
+    double val = 0.0;
+    for (int t = 0; t <= la[0] + lb[0]; t++)
+    {
+      for (int u = 0; u <= la[1] + lb[1]; u++)
+      {
+        const double Etu = pp.Ex(la[0], lb[0], t)*pp.Ey(la[1], lb[1], u);
+        for (int w = 0; w <= la[2] + lb[2]; w++)
+        {
+          val += Etu*pp.Ez(la[2], lb[2], w)*R(t, u, w);
+        }
+      }
+    }
+    v += pp.coef*val*2*M_PI/pp.p;   // (9.9.40)
+  }
+  return v;
+}
+
+double electron_repulsion(const ShellPair& ab, const ShellPair& cd)
+{
+  const auto& la = ab.la();
+  const auto& lb = ab.lb();
+  const auto& lc = cd.la();
+  const auto& ld = cd.lb();
+  const int T1 = la[0] + lb[0], U1 = la[1] + lb[1], V1 = la[2] + lb[2];
+  const int T2 = lc[0] + ld[0], U2 = lc[1] + ld[1], V2 = lc[2] + ld[2];
+
+  const int L = ab.L() + cd.L();
+  const long nab = long(ab.primitives().size());
+
+  thread_local HermiteR R;
+  thread_local std::vector<double> Ecd;
+  thread_local std::vector<double> Tab, Fab;
+  Tab.resize(nab);
+  Fab.resize(nab*(L + 1));
+
+  double eri = 0.0;
+  for (const auto& q : cd.primitives())
+  {
+    // (-1)^(τ+ν+ϕ) E^{cd}_{τνϕ}, shared by all bra primitives
+    Ecd.resize((T2 + 1)*(U2 + 1)*(V2 + 1));
+    for (int tau = 0, k = 0; tau <= T2; tau++)
+    {
+      for (int nu = 0; nu <= U2; nu++)
+      {
+        for (int phi = 0; phi <= V2; phi++, k++)
+        {
+          const double sign = ((tau + nu + phi) % 2) ? -1.0 : 1.0;
+          Ecd[k] = sign*q.Ex(lc[0], ld[0], tau)*q.Ey(lc[1], ld[1], nu)*
+                   q.Ez(lc[2], ld[2], phi);
+        }
+      }
+    }
+
+    // Boys function of every bra primitive in one batch
+    for (long i = 0; i < nab; i++)
+    {
+      const auto& p = ab.primitives()[i];
+      const double alpha = p.p*q.p/(p.p + q.p);   // (9.7.22)
+      const double dx = p.P[0] - q.P[0], dy = p.P[1] - q.P[1], dz = p.P[2] - q.P[2];
+      Tab[i] = alpha*(dx*dx + dy*dy + dz*dz);
+    }
+    boys_batch(L, nab, Tab.data(), Fab.data());
+
+    for (long i = 0; i < nab; i++)
+    {
+      const auto& p = ab.primitives()[i];
+      const double alpha = p.p*q.p/(p.p + q.p);
+      const std::array<double,3> PQ = {p.P[0] - q.P[0], p.P[1] - q.P[1], p.P[2] - q.P[2]};
+      R.compute(L, alpha, PQ, Fab.data() + i, nab);
+
+      double val = 0.0;
+      for (int t = 0; t <= T1; t++)
+      {
+        for (int u = 0; u <= U1; u++)
+        {
+          for (int v = 0; v <= V1; v++)
+          {
+            const double Eab = p.Ex(la[0], lb[0], t)*p.Ey(la[1], lb[1], u)*
+                               p.Ez(la[2], lb[2], v);
+            double inner = 0.0;
+            for (int tau = 0, k = 0; tau <= T2; tau++)
+            {
+              for (int nu = 0; nu <= U2; nu++)
+              {
+                for (int phi = 0; phi <= V2; phi++, k++)
+                {
+                  inner += Ecd[k]*R(t + tau, u + nu, v + phi);
+                }
+              }
+            }
+            val += Eab*inner;
+          }
+        }
+      }
+      eri += p.coef*q.coef*val*
+             2*std::pow(M_PI, 2.5)/(p.p*q.p*std::sqrt(p.p + q.p));   // (9.9.33)
+    }
+  }
+  return eri;
+}
+
+double electron_repulsion(const BasisFunction& a, const BasisFunction& b,
+                          const BasisFunction& c, const BasisFunction& d)
+{
+  return electron_repulsion(ShellPair(a, b), ShellPair(c, d));
+}
+
+} // namespace mmd
@@ -0,0 +1,113 @@
+// References:
+// - (HJO) "Molecular Electronic Structure Theory" 1st ed. by T. Helgaker, P. Jorgensen, J. Olsen
+//         is the default reference
+// - (FV) "Fundamentals of Molecular Integrals Evaluation" by J. T. Fermann, E. Valeev
+//
+// Native McMurchie-Davidson engine, the C++ counterpart of McMurchieDavidson.jl.
+// Instead of the recursive E() and R() the Hermite expansion coefficients are
+// tabulated bottom-up once per primitive pair (ShellPair) and the Hermite
+// Coulomb integrals once per primitive pair/quartet (HermiteR).
+
+#ifndef MCMURCHIE_DAVIDSON_HPP
+#define MCMURCHIE_DAVIDSON_HPP
+
+#include <array>
+#include <vector>
+
+namespace mmd
+{
+
+// Contracted Cartesian Gaussian, as BasisFunction in basis-set.jl: `norm`
+// holds the primitive normalizations and `coefs` the contraction
+// coefficients (normalize_basis! included).
+struct BasisFunction
+{
+  std::array<double,3> origin;
+  std::array<int,3> shell;     // (l, m, n), e.g. pₓ is (1, 0, 0)
+  std::vector<double> exps;
+  std::vector<double> coefs;
+  std::vector<double> norm;
+};
+
+// Hermite expansion coefficients E^{ij}_t of one Cartesian direction for all
+// i ≤ imax, j ≤ jmax and t ≤ i + j, filled bottom-up with (9.5.6)-(9.5.8).
+class HermiteE
+{
+public:
+  HermiteE() = default;
+  HermiteE(int imax, int jmax, double Qx, double a, double b);
+
+  double operator()(int i, int j, int t) const
+  {
+    return (t < 0 || t > i + j) ? 0.0 : data_[(i*(jmax_ + 1) + j)*tdim_ + t]; // (9.5.5)
+  }
+
+private:
+  int jmax_ = 0;
+  int tdim_ = 1;
+  std::vector<double> data_;
+};
+
+// Hermite Coulomb integrals R^0_{tuv}(p, PC) for all t + u + v ≤ L (9.9.13),
+// filled bottom-up with (9.9.18)-(9.9.20) from the Boys function (9.9.14).
+// The storage is reused between calls.
+class HermiteR
+{
+public:
+  void compute(int L, double p, const std::array<double,3>& PC);
+
+  // Same, with F_n(p |PC|²) already evaluated at F[n*stride] (boys_batch)
+  void compute(int L, double p, const std::array<double,3>& PC,
+               const double* F, long stride);
+
+  double operator()(int t, int u, int v) const
+  {
+    return data_[(t*dim_ + u)*dim_ + v]; // n = 0 level
+  }
+
+private:
+  int dim_ = 0;
+  std::vector<double> data_;
+  std::vector<double> boys_;
+};
+
+// Primitive pair of a ShellPair, with its Hermite expansion tables
+struct PrimitivePair
+{
+  double a, b;                 // exponents
+  double p;                    // a + b (9.2.10)
+  std::array<double,3> P;      // centre of charge (9.2.13)
+  double coef;                 // product of norms and contraction coefficients
+  HermiteE Ex, Ey, Ez;
+};
+
+// Every primitive pair of two contracted functions, built once and reused
+// for all the integrals in which the pair appears. `jextra` raises the
+// angular momentum of the second function in the tables (2 for kinetic).
+class ShellPair
+{
+public:
+  ShellPair(const BasisFunction& a, const BasisFunction& b, int jextra = 0);
+
+  const std::array<int,3>& la() const { return la_; }
+  const std::array<int,3>& lb() const { return lb_; }
+  int L() const { return la_[0] + la_[1] + la_[2] + lb_[0] + lb_[1] + lb_[2]; }
+  const std::vector<PrimitivePair>& primitives() const { return prims_; }
+
+private:
+  std::array<int,3> la_, lb_;
+  std::vector<PrimitivePair> prims_;
+};
+
+// Contracted integrals, same conventions as S, T, V and ERI in McMurchieDavidson.jl
+double overlap(const BasisFunction& a, const BasisFunction& b);
+double kinetic(const BasisFunction& a, const BasisFunction& b);
+double nuclear_attraction(const BasisFunction& a, const BasisFunction& b,
+                          const std::array<double,3>& C);
+double electron_repulsion(const ShellPair& ab, const ShellPair& cd);
+double electron_repulsion(const BasisFunction& a, const BasisFunction& b,
+                          const BasisFunction& c, const BasisFunction& d);
+
+} // namespace mmd
+
+#endif
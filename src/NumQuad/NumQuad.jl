@@ -28,4 +28,15 @@ include("multiexp.jl")
 include("perez_jorda.jl")
 
 include("lebedev/lebedev-laikov.jl")
+include("molecular_grid.jl")
+
+# Compiled into the package image (Julia ≥ 1.9); a sysimage with the whole
+# workload is built by src/precompilations/build_numquad.jl
+precompile(lebedev_laikov_wrapper, (Int,))
+precompile(lebedev_laikov_table, (Int,))
+precompile(lebedev_laikov_spherical, (Int,))
+precompile(atomic_grid, (Int, Int))
+precompile(molecular_grid, (Matrix{Float64}, Int, Int))
+precompile(grid_integrate, (Vector{Float64}, Vector{Float64}))
+precompile(reproducible_sum, (Vector{Float64},))
 end
@@ -0,0 +1,171 @@
+# include <new>
+# include <vector>
+
+# include <benchmark/benchmark.h>
+
+# include "lebedev-laikov.h"
+# include "molecular-grid.h"
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    Micro-benchmarks of the native Lebedev-Laikov layer (Google Benchmark).
+
+  Discussion:
+
+    Build with -DLEBEDEV_BENCHMARKS=ON, or run run.sh, which writes the
+    results as JSON:
+      bench_lebedev --benchmark_out=lebedev.json --benchmark_out_format=json
+
+    Every rule-dependent benchmark is registered for all 32 available
+    orders, so a regression in a single rule shows up on its own line.
+*/
+namespace
+{
+
+void all_orders ( benchmark::internal::Benchmark *b )
+{
+  for ( int rule = 1; rule <= 65; rule++ )
+  {
+    if ( available_table ( rule ) == 1 )
+    {
+      b->Arg ( order_table ( rule ) );
+    }
+  }
+}
+
+/*
+  Runtime generation of a rule by the gen_oh calls of its ldNNNN routine.
+*/
+void BM_ld_by_order ( benchmark::State &state )
+{
+  int order = ( int ) state.range ( 0 );
+  std::vector<double> x ( order ), y ( order ), z ( order ), w ( order );
+
+  for ( auto _ : state )
+  {
+    ld_by_order ( order, x.data ( ), y.data ( ), z.data ( ), w.data ( ) );
+    benchmark::DoNotOptimize ( w.data ( ) );
+    benchmark::ClobberMemory ( );
+  }
+  state.SetItemsProcessed ( state.iterations ( ) * order );
+}
+BENCHMARK ( BM_ld_by_order )->Apply ( all_orders );
+
+/*
+  The same rule from the compile-time tables: a lookup, no computation.
+*/
+void BM_ld_table_by_order ( benchmark::State &state )
+{
+  int order = ( int ) state.range ( 0 );
+  const double *x, *y, *z, *w;
+
+  for ( auto _ : state )
+  {
+    benchmark::DoNotOptimize ( ld_table_by_order ( order, &x, &y, &z, &w ) );
+  }
+}
+BENCHMARK ( BM_ld_table_by_order )->Apply ( all_orders );
+
+/*
+  A copy of the tables into aligned, padded caller buffers.
+*/
+void BM_ld_by_order_padded ( benchmark::State &state )
+{
+  int order = ( int ) state.range ( 0 );
+  int len = ld_padded_length ( order, 8 );
+  double *x = new ( std::align_val_t ( LEBEDEV_ALIGNMENT ) ) double[4*len];
+
+  for ( auto _ : state )
+  {
+    ld_by_order_padded ( order, 8, x, x + len, x + 2 * len, x + 3 * len );
+    benchmark::DoNotOptimize ( x );
+    benchmark::ClobberMemory ( );
+  }
+  state.SetBytesProcessed ( state.iterations ( ) * 4 * len * sizeof ( double ) );
+  operator delete[] ( x, std::align_val_t ( LEBEDEV_ALIGNMENT ) );
+}
+BENCHMARK ( BM_ld_by_order_padded )->Apply ( all_orders );
+
+/*
+  One orbit of every symmetry code, 6 to 48 points.
+*/
+void BM_gen_oh ( benchmark::State &state )
+{
+  int code = ( int ) state.range ( 0 );
+  double x[48], y[48], z[48], w[48];
+  int n = 0;
+
+  for ( auto _ : state )
+  {
+    n = gen_oh ( code, 0.3, 0.5, 1.0, x, y, z, w );
+    benchmark::DoNotOptimize ( w );
+    benchmark::ClobberMemory ( );
+  }
+  state.SetItemsProcessed ( state.iterations ( ) * n );
+}
+BENCHMARK ( BM_gen_oh )->DenseRange ( 1, 6 );
+
+/*
+  Cartesian to spherical conversion of a whole grid, point by point and
+  batched.
+*/
+void BM_xyz_to_tp ( benchmark::State &state )
+{
+  int order = ( int ) state.range ( 0 );
+  const double *x, *y, *z, *w;
+  std::vector<double> t ( order ), p ( order );
+
+  ld_table_by_order ( order, &x, &y, &z, &w );
+  for ( auto _ : state )
+  {
+    for ( int i = 0; i < order; i++ )
+    {
+      xyz_to_tp ( x[i], y[i], z[i], &t[i], &p[i] );
+    }
+    benchmark::DoNotOptimize ( p.data ( ) );
+    benchmark::ClobberMemory ( );
+  }
+  state.SetItemsProcessed ( state.iterations ( ) * order );
+}
+BENCHMARK ( BM_xyz_to_tp )->Apply ( all_orders );
+
+void BM_xyz_to_tp_batch ( benchmark::State &state )
+{
+  int order = ( int ) state.range ( 0 );
+  const double *x, *y, *z, *w;
+  std::vector<double> t ( order ), p ( order );
+
+  ld_table_by_order ( order, &x, &y, &z, &w );
+  for ( auto _ : state )
+  {
+    xyz_to_tp_batch ( order, x, y, z, t.data ( ), p.data ( ),
+                      LEBEDEV_DEGREES );
+    benchmark::DoNotOptimize ( p.data ( ) );
+    benchmark::ClobberMemory ( );
+  }
+  state.SetItemsProcessed ( state.iterations ( ) * order );
+}
+BENCHMARK ( BM_xyz_to_tp_batch )->Apply ( all_orders );
+
+/*
+  A hit in the process-wide atomic grid cache (the first call builds it).
+*/
+void BM_atomic_grid ( benchmark::State &state )
+{
+  int order = ( int ) state.range ( 0 );
+  const double *x, *y, *z, *w;
+
+  atomic_grid ( order, MOLECULAR_GRID_GAUSS_CHEBYSHEV2ND, 75, &x, &y, &z, &w );
+  for ( auto _ : state )
+  {
+    benchmark::DoNotOptimize ( atomic_grid ( order,
+      MOLECULAR_GRID_GAUSS_CHEBYSHEV2ND, 75, &x, &y, &z, &w ) );
+  }
+}
+BENCHMARK ( BM_atomic_grid )->Arg ( 302 )->ThreadRange ( 1, 8 );
+
+}
+
+BENCHMARK_MAIN ( );
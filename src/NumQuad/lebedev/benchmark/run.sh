@@ -0,0 +1,11 @@
+
+# Build liblebedev with its micro-benchmarks and write the results as JSON
+# (default: lebedev.json; pass another file name as the first argument)
+cd "$(dirname "$0")/.."
+out="${1:-$PWD/benchmark/lebedev.json}"
+
+rm -Rf build
+mkdir build && cd build
+cmake -DCMAKE_BUILD_TYPE=Release -DLEBEDEV_BENCHMARKS=ON ..
+cmake --build . --config Release
+./bench_lebedev --benchmark_out="$out" --benchmark_out_format=json
@@ -0,0 +1,70 @@
+
+# Extract the orbit generators (code, a, b, v) of every ldNNNN routine of
+# lebedev-laikov.c and write them as constexpr C++ tables, which
+# lebedev-laikov-table.cpp expands into the full grids at compile time.
+#
+# Run it again whenever lebedev-laikov.c changes:
+#    julia generate_lebedev_laikov_orbits.jl
+
+const LEBEDEVSOURCE = joinpath(@__DIR__, "lebedev-laikov.c")
+const ORBITSOUTPUT  = joinpath(@__DIR__, "lebedev-laikov-orbits.hpp")
+
+function parse_orbits(source)
+   rules = Pair{Int,Vector{NTuple{4,String}}}[]
+   a, b, v = "0.0", "0.0", "0.0"
+   for line in eachline(source)
+      m = match(r"^void ld(\d{4}) \(", line)
+      if m !== nothing
+         push!(rules, parse(Int, m[1]) => NTuple{4,String}[])
+         a, b, v = "0.0", "0.0", "0.0"
+         continue
+      end
+      isempty(rules) && continue
+      m = match(r"^\s+([abv]) = ([-+.0-9e]+)\s*;", line)
+      if m !== nothing
+         m[1] == "a" && (a = m[2])
+         m[1] == "b" && (b = m[2])
+         m[1] == "v" && (v = m[2])
+         continue
+      end
+      m = match(r"gen_oh \( (\d),", line)
+      if m !== nothing
+         code = m[1]
+         # Codes 1-3 ignore A and B; codes 4 and 5 derive B from A.
+         push!(rules[end].second, (code,
+                                   code in ("4", "5", "6") ? a : "0.0",
+                                   code == "6" ? b : "0.0",
+                                   v))
+      end
+   end
+   rules
+end
+
+const MULTIPLICITY = Dict("1" => 6, "2" => 12, "3" => 8, "4" => 24, "5" => 24, "6" => 48)
+
+open(ORBITSOUTPUT, "w") do f
+
+   rules = parse_orbits(LEBEDEVSOURCE)
+
+   write(f, "// Generated by generate_lebedev_laikov_orbits.jl from lebedev-laikov.c.\n")
+   write(f, "// Do not edit by hand.\n")
+   write(f, "//\n")
+   write(f, "// Each entry is { code, a, b, v }, the arguments of one gen_oh call.\n")
+   for (order, orbits) in rules
+      @assert sum(MULTIPLICITY[o[1]] for o in orbits) == order
+      name = "ld" * lpad(order, 4, '0')
+      write(f, "\n")
+      write(f, "constexpr Orbit $(name)_orbits[] = {\n")
+      for (code, a, b, v) in orbits
+         write(f, "  { $code, $a, $b, $v },\n")
+      end
+      write(f, "};\n")
+   end
+   write(f, "\n")
+   write(f, "#define LEBEDEV_LAIKOV_RULES(RULE) \\\n")
+   for (i, (order, orbits)) in enumerate(rules)
+      name = "ld" * lpad(order, 4, '0')
+      sep = i == length(rules) ? "\n" : " \\\n"
+      write(f, "  RULE($order, $name)$sep")
+   end
+end
@@ -0,0 +1,233 @@
+# include <atomic>
+# include <cmath>
+# include <cstdlib>
+# include <vector>
+
+# include "instrument.h"
+# include "lebedev-laikov.h"
+# include "molecular-grid.h"
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    Process-wide cache of atomic grids (radial x Lebedev), shared by all
+    threads without locks.
+
+  Discussion:
+
+    Every (Lebedev order, radial scheme, number of shells) has a slot
+    holding an atomic pointer to an immutable grid.  A lookup is a single
+    acquire load.  On a miss the caller builds the grid and publishes it
+    with a compare-and-swap; if another thread won the race the loser's copy
+    is freed and the published one is used, so nobody ever waits.
+
+    Published grids are never freed: they live as long as the process, and
+    pointers to them may be kept freely.
+*/
+namespace
+{
+
+const double pi = 3.14159265358979323846;
+
+const int orders[32] = {
+    6,   14,   26,   38,   50,   74,   86,  110,  146,  170,
+  194,  230,  266,  302,  350,  434,  590,  770,  974, 1202,
+ 1454, 1730, 2030, 2354, 2702, 3074, 3470, 3890, 4334, 4802,
+ 5294, 5810 };
+
+struct Grid
+{
+  long n;
+  double data[1];   /* x, y, z and w blocks of n doubles */
+};
+
+std::atomic<const Grid *> slots[32][2][MOLECULAR_GRID_MAX_RADIAL];
+
+int rule_index ( int order )
+{
+  for ( int i = 0; i < 32; i++ )
+  {
+    if ( orders[i] == order )
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const Grid *build ( int nang, int radial, int nrad )
+{
+  const double *ux, *uy, *uz, *uw;
+  long n = ( long ) nang * nrad;
+  Grid *g = static_cast<Grid *> ( malloc ( sizeof ( Grid )
+    + ( 4 * n - 1 ) * sizeof ( double ) ) );
+
+  if ( g == nullptr )
+  {
+    return nullptr;
+  }
+  g->n = n;
+  double *x = g->data;
+  double *y = x + n;
+  double *z = y + n;
+  double *w = z + n;
+  std::vector<double> r ( nrad );
+  std::vector<double> wr ( nrad );
+  radial_grid ( radial, nrad, r.data ( ), wr.data ( ) );
+
+  ld_table_by_order ( nang, &ux, &uy, &uz, &uw );
+
+  for ( int i = 0; i < nrad; i++ )
+  {
+    double wi = 4.0 * pi * wr[i];
+    for ( int j = 0; j < nang; j++ )
+    {
+      long k = ( long ) i * nang + j;
+      x[k] = r[i] * ux[j];
+      y[k] = r[i] * uy[j];
+      z[k] = r[i] * uz[j];
+      w[k] = wi * uw[j];
+    }
+  }
+  return g;
+}
+
+}
+/******************************************************************************/
+
+int radial_grid ( int radial, int n, double *r, double *w )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    RADIAL_GRID returns a radial grid over [0,oo).
+
+  Discussion:
+
+    The rules for [-1,1] use the same formulae as perez_jorda.jl and
+    gauss_chebyshev2nd.jl, and are mapped with Becke's transformation
+    r = (1+x)/(1-x).  The weights include the volume element r^2 dr.
+
+  Parameters:
+
+    Input, int RADIAL, MOLECULAR_GRID_PEREZ_JORDA or
+    MOLECULAR_GRID_GAUSS_CHEBYSHEV2ND.
+
+    Input, int N, the number of shells.
+
+    Output, double R[N], W[N], the shells, from the nucleus outwards, and
+    their weights.
+
+    Output, int RADIAL_GRID, 0, or MOLECULAR_GRID_EINVAL.
+*/
+{
+  LD_INSTRUMENT_SCOPE ( LD_SITE_RADIAL_GRID );
+  double dn = n + 1;
+
+  if ( n < 1 || ( radial != MOLECULAR_GRID_PEREZ_JORDA &&
+                  radial != MOLECULAR_GRID_GAUSS_CHEBYSHEV2ND ) )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+
+  for ( int i = 1; i <= n; i++ )
+  {
+    double t = i * pi / dn;
+    double st = sin ( t );
+    double ct = cos ( t );
+    double x;
+    double wx;
+
+    if ( radial == MOLECULAR_GRID_PEREZ_JORDA )
+    {
+      wx = n == 1 ? 2.0 : 16.0 / 3.0 / dn * st * st * st * st;
+      x = -1.0 + 2.0 * i / dn
+        - 2.0 / pi * ( 1.0 + 2.0 / 3.0 * st * st ) * ct * st;
+    }
+    else
+    {
+      wx = pi / dn * st;
+      x = - ct;
+    }
+    r[i-1] = ( 1.0 + x ) / ( 1.0 - x );
+    w[i-1] = wx * 2.0 / ( ( 1.0 - x ) * ( 1.0 - x ) ) * r[i-1] * r[i-1];
+  }
+  return 0;
+}
+/******************************************************************************/
+
+long atomic_grid ( int nang, int radial, int nrad, const double **x,
+  const double **y, const double **z, const double **w )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ATOMIC_GRID returns the cached grid of an atom at the origin.
+
+  Discussion:
+
+    The grid is the product of RADIAL_GRID ( RADIAL, NRAD ) and the Lebedev
+    grid of order NANG, shell after shell, with weights including r^2 dr
+    and the 4 pi of the solid angle.  It is built on first use and then
+    shared by every thread of the process; lookups never block.
+
+    Y, Z and W follow X contiguously, like in LD_TABLE_BY_ORDER.
+
+  Parameters:
+
+    Input, int NANG, the Lebedev order.
+
+    Input, int RADIAL, the radial scheme.
+
+    Input, int NRAD, the number of shells, at most
+    MOLECULAR_GRID_MAX_RADIAL.
+
+    Output, const double **X, **Y, **Z, **W, the points and weights,
+    which must not be modified.  Left untouched on error.
+
+    Output, long ATOMIC_GRID, the number of points, NANG * NRAD, or
+    MOLECULAR_GRID_EINVAL for invalid arguments and MOLECULAR_GRID_ENOMEM
+    if the grid could not be allocated.
+*/
+{
+  LD_INSTRUMENT_SCOPE ( LD_SITE_ATOMIC_GRID );
+  int rule = rule_index ( nang );
+
+  if ( rule < 0 || nrad < 1 || MOLECULAR_GRID_MAX_RADIAL < nrad ||
+       ( radial != MOLECULAR_GRID_PEREZ_JORDA &&
+         radial != MOLECULAR_GRID_GAUSS_CHEBYSHEV2ND ) )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+
+  std::atomic<const Grid *> &slot = slots[rule][radial-1][nrad-1];
+  const Grid *g = slot.load ( std::memory_order_acquire );
+
+  if ( g == nullptr )
+  {
+    const Grid *mine = build ( nang, radial, nrad );
+    if ( mine == nullptr )
+    {
+      return MOLECULAR_GRID_ENOMEM;
+    }
+    if ( slot.compare_exchange_strong ( g, mine, std::memory_order_acq_rel,
+                                              std::memory_order_acquire ) )
+    {
+      g = mine;
+    }
+    else
+    {
+      free ( const_cast<Grid *> ( mine ) );
+    }
+  }
+
+  *x = g->data;
+  *y = g->data + g->n;
+  *z = g->data + 2 * g->n;
+  *w = g->data + 3 * g->n;
+
+  return g->n;
+}
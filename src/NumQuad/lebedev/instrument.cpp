@@ -0,0 +1,243 @@
+# include <atomic>
+# include <chrono>
+# include <cstdio>
+# include <mutex>
+# include <string>
+# include <vector>
+
+# if defined ( __x86_64__ ) || defined ( __i386__ )
+# include <x86intrin.h>
+# endif
+
+# include "instrument.h"
+# include "lebedev-laikov.h"
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    Counters, timers and trace events of the probes of instrument.h.
+
+  Discussion:
+
+    Every thread owns a block of counters, created on its first probe and
+    registered in a global list (the only lock, once per thread). A probe
+    only updates its own thread's block, with relaxed loads and stores, so
+    probes never contend; queries add up the blocks of all threads.
+    Blocks are never freed, so the counts of finished threads are kept.
+
+    While a trace is recorded, every probe also appends a complete event
+    (name, thread, start and duration) to a buffer of its thread.
+*/
+namespace
+{
+
+const char *names[LD_SITE_COUNT] = {
+  "ld_by_order",
+  "ld_table_by_order",
+  "ld_by_order_padded",
+  "ld_spherical_by_order",
+  "radial_grid",
+  "atomic_grid",
+  "molecular_grid",
+  "pruned_molecular_grid" };
+
+struct Event
+{
+  int site;
+  unsigned long long start, duration;
+};
+
+struct Counters
+{
+  std::atomic<long> calls[LD_SITE_COUNT];
+  std::atomic<unsigned long long> ns[LD_SITE_COUNT];
+  std::atomic<unsigned long long> cycles[LD_SITE_COUNT];
+  std::atomic<long> histogram[LD_SITE_COUNT][LD_INSTRUMENT_BUCKETS];
+
+  int tid;
+  std::mutex events_mutex;
+  std::vector<Event> events;
+};
+
+std::mutex registry_mutex;
+std::vector<Counters *> registry;
+std::atomic<bool> tracing ( false );
+std::string trace_path;
+
+Counters &counters ( )
+{
+  thread_local Counters *mine = nullptr;
+  if ( mine == nullptr )
+  {
+    Counters *c = new Counters ( );
+    std::lock_guard<std::mutex> lock ( registry_mutex );
+    c->tid = ( int ) registry.size ( );
+    registry.push_back ( c );
+    mine = c;
+  }
+  return *mine;
+}
+
+template <typename T>
+inline void add ( std::atomic<T> &counter, T value )
+{
+  counter.store ( counter.load ( std::memory_order_relaxed ) + value,
+                  std::memory_order_relaxed );
+}
+
+inline unsigned long long now_ns ( )
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds> (
+    std::chrono::steady_clock::now ( ).time_since_epoch ( ) ).count ( );
+}
+
+inline unsigned long long now_cycles ( )
+{
+# if defined ( __x86_64__ ) || defined ( __i386__ )
+  return __rdtsc ( );
+# else
+  return 0;
+# endif
+}
+
+int bucket ( unsigned long long ns )
+{
+  int b = 0;
+  while ( 1ULL < ns && b < LD_INSTRUMENT_BUCKETS - 1 )
+  {
+    ns >>= 1;
+    b++;
+  }
+  return b;
+}
+
+}
+
+/******************************************************************************/
+
+int ld_instrument_enabled ( void )
+{
+# ifdef LEBEDEV_INSTRUMENT
+  return 1;
+# else
+  return 0;
+# endif
+}
+
+ld_instrument_time ld_instrument_begin ( void )
+{
+  return { now_ns ( ), now_cycles ( ) };
+}
+
+void ld_instrument_end ( int site, ld_instrument_time start )
+{
+  const unsigned long long cycles = now_cycles ( ) - start.cycles;
+  const unsigned long long ns = now_ns ( ) - start.ns;
+  Counters &c = counters ( );
+
+  add ( c.calls[site], 1L );
+  add ( c.ns[site], ns );
+  add ( c.cycles[site], cycles );
+  add ( c.histogram[site][bucket ( ns )], 1L );
+
+  if ( tracing.load ( std::memory_order_relaxed ) )
+  {
+    std::lock_guard<std::mutex> lock ( c.events_mutex );
+    c.events.push_back ( { site, start.ns, ns } );
+  }
+}
+
+int ld_instrument_get ( int site, ld_instrument_stats *stats )
+{
+  if ( site < 0 || LD_SITE_COUNT <= site || stats == nullptr )
+  {
+    return LEBEDEV_EINVAL;
+  }
+  *stats = ld_instrument_stats ( );
+  stats->name = names[site];
+
+  unsigned long long ns = 0;
+  std::lock_guard<std::mutex> lock ( registry_mutex );
+  for ( Counters *c : registry )
+  {
+    stats->calls += c->calls[site].load ( std::memory_order_relaxed );
+    ns += c->ns[site].load ( std::memory_order_relaxed );
+    stats->cycles += c->cycles[site].load ( std::memory_order_relaxed );
+    for ( int b = 0; b < LD_INSTRUMENT_BUCKETS; b++ )
+    {
+      stats->histogram[b] += c->histogram[site][b].load ( std::memory_order_relaxed );
+    }
+  }
+  stats->seconds = 1e-9 * ns;
+  return LEBEDEV_SUCCESS;
+}
+
+/*
+  Not atomic with respect to probes running at the same time: their calls
+  may or may not be counted
+*/
+void ld_instrument_reset ( void )
+{
+  std::lock_guard<std::mutex> lock ( registry_mutex );
+  for ( Counters *c : registry )
+  {
+    for ( int s = 0; s < LD_SITE_COUNT; s++ )
+    {
+      c->calls[s].store ( 0, std::memory_order_relaxed );
+      c->ns[s].store ( 0, std::memory_order_relaxed );
+      c->cycles[s].store ( 0, std::memory_order_relaxed );
+      for ( int b = 0; b < LD_INSTRUMENT_BUCKETS; b++ )
+      {
+        c->histogram[s][b].store ( 0, std::memory_order_relaxed );
+      }
+    }
+  }
+}
+
+int ld_instrument_trace ( const char *path )
+{
+  std::lock_guard<std::mutex> lock ( registry_mutex );
+
+  if ( path != nullptr )
+  {
+    trace_path = path;
+    for ( Counters *c : registry )
+    {
+      std::lock_guard<std::mutex> events_lock ( c->events_mutex );
+      c->events.clear ( );
+    }
+    tracing.store ( true );
+    return LEBEDEV_SUCCESS;
+  }
+
+  if ( !tracing.exchange ( false ) )
+  {
+    return LEBEDEV_EINVAL;
+  }
+  FILE *file = std::fopen ( trace_path.c_str ( ), "w" );
+  if ( file == nullptr )
+  {
+    return LEBEDEV_EINVAL;
+  }
+/*
+  Complete ("X") events, times in microseconds
+*/
+  std::fprintf ( file, "{\"traceEvents\":[" );
+  const char *separator = "\n";
+  for ( Counters *c : registry )
+  {
+    std::lock_guard<std::mutex> events_lock ( c->events_mutex );
+    for ( const Event &e : c->events )
+    {
+      std::fprintf ( file,
+        "%s{\"name\":\"%s\",\"cat\":\"lebedev\",\"ph\":\"X\",\"pid\":1,"
+        "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+        separator, names[e.site], c->tid, 1e-3 * e.start, 1e-3 * e.duration );
+      separator = ",\n";
+    }
+    c->events.clear ( );
+  }
+  std::fprintf ( file, "\n],\"displayTimeUnit\":\"ns\"}\n" );
+  return std::fclose ( file ) == 0 ? LEBEDEV_SUCCESS : LEBEDEV_EINVAL;
+}
@@ -0,0 +1,101 @@
+/*
+  Instrumentation of the native entry points of LIBLEBEDEV: per-thread call
+  counts, wall and cycle timers, histograms of the call durations and an
+  optional Chrome trace (also read by Perfetto).
+
+  The probes are compiled out unless the library is built with
+  LEBEDEV_INSTRUMENT defined (CMakeLists.txt: -DLEBEDEV_INSTRUMENT=ON); the
+  query functions are always there, and then report no calls.
+
+  To instrument a new function, add its site to ld_site (and its name to
+  instrument.cpp) and wrap its body with LD_INSTRUMENT_BEGIN/END, or use
+  LD_INSTRUMENT_SCOPE in C++.
+*/
+# ifndef LEBEDEV_INSTRUMENT_H
+# define LEBEDEV_INSTRUMENT_H
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+typedef enum
+{
+  LD_SITE_BY_ORDER,
+  LD_SITE_TABLE_BY_ORDER,
+  LD_SITE_BY_ORDER_PADDED,
+  LD_SITE_SPHERICAL_BY_ORDER,
+  LD_SITE_RADIAL_GRID,
+  LD_SITE_ATOMIC_GRID,
+  LD_SITE_MOLECULAR_GRID,
+  LD_SITE_PRUNED_MOLECULAR_GRID,
+  LD_SITE_COUNT
+} ld_site;
+
+/* Histogram buckets: bucket b counts the calls of 2^b <= ns < 2^(b+1) */
+# define LD_INSTRUMENT_BUCKETS 32
+
+typedef struct
+{
+  const char *name;
+  long calls;
+  double seconds;                          /* wall time */
+  unsigned long long cycles;               /* time stamp counter, 0 if none */
+  long histogram[LD_INSTRUMENT_BUCKETS];
+} ld_instrument_stats;
+
+typedef struct
+{
+  unsigned long long ns, cycles;
+} ld_instrument_time;
+
+/* 1 if the probes were compiled in */
+int ld_instrument_enabled ( void );
+/* Totals of SITE over all threads; LEBEDEV_EINVAL for an unknown site */
+int ld_instrument_get ( int site, ld_instrument_stats *stats );
+void ld_instrument_reset ( void );
+/* Start recording trace events, or with PATH NULL stop and write the events
+   recorded so far to the file given at the start, as Chrome trace JSON */
+int ld_instrument_trace ( const char *path );
+
+ld_instrument_time ld_instrument_begin ( void );
+void ld_instrument_end ( int site, ld_instrument_time start );
+
+# ifdef __cplusplus
+}
+# endif
+
+# ifdef LEBEDEV_INSTRUMENT
+# define LD_INSTRUMENT_BEGIN(site) \
+  const ld_instrument_time ld_instrument_start_##site = ld_instrument_begin ( )
+# define LD_INSTRUMENT_END(site) \
+  ld_instrument_end ( site, ld_instrument_start_##site )
+# else
+# define LD_INSTRUMENT_BEGIN(site) ( ( void ) 0 )
+# define LD_INSTRUMENT_END(site) ( ( void ) 0 )
+# endif
+
+# ifdef __cplusplus
+/*
+  Probe of the enclosing scope, for functions with several returns
+*/
+class LdInstrumentScope
+{
+public:
+  explicit LdInstrumentScope ( int site ) : site_ ( site ), start_ ( ld_instrument_begin ( ) ) { }
+  ~LdInstrumentScope ( ) { ld_instrument_end ( site_, start_ ); }
+  LdInstrumentScope ( const LdInstrumentScope & ) = delete;
+  LdInstrumentScope &operator= ( const LdInstrumentScope & ) = delete;
+
+private:
+  int site_;
+  ld_instrument_time start_;
+};
+
+# ifdef LEBEDEV_INSTRUMENT
+# define LD_INSTRUMENT_SCOPE(site) const LdInstrumentScope ld_instrument_scope ( site )
+# else
+# define LD_INSTRUMENT_SCOPE(site) ( ( void ) 0 )
+# endif
+# endif
+
+# endif
@@ -0,0 +1,115 @@
+# include <math.h>
+
+# include "instrument.h"
+# include "lebedev-laikov.h"
+
+/*
+  This file is compiled with -ffast-math -fopenmp-simd (see CMakeLists.txt),
+  which lets GCC call the vector ATAN2 and ACOS of glibc's libmvec from the
+  OMP SIMD loop below.  The loop does not rely on signed zeros, infinities
+  or NaNs, so the results agree with XYZ_TO_TP to a few ulps.
+*/
+
+/******************************************************************************/
+
+void xyz_to_tp_batch ( long n, const double *x, const double *y,
+  const double *z, double *t, double *p, int units )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    XYZ_TO_TP_BATCH converts N points (X,Y,Z) to (Theta,Phi) coordinates.
+
+  Discussion:
+
+    Same conventions as XYZ_TO_TP: Theta, in (-pi,pi], is the azimuth
+    measured from the X axis (pi/2 at the poles), and Phi, in [0,pi], the
+    polar angle measured from the Z axis.  Unlike XYZ_TO_TP, the angles are
+    returned in radians or degrees, as requested.
+
+    The loop is branch free, so that it is vectorised.
+
+  Parameters:
+
+    Input, long N, the number of points.
+
+    Input, const double X[N], Y[N], Z[N], the Cartesian coordinates of
+    points on the unit sphere.
+
+    Output, double T[N], P[N], the Theta and Phi coordinates of the
+    points.  They must not overlap the inputs.
+
+    Input, int UNITS, LEBEDEV_RADIANS or LEBEDEV_DEGREES.
+*/
+{
+  const double half_pi = 1.57079632679489661923;
+  const double scale = ( units == LEBEDEV_DEGREES ) ?
+    180.0 / 3.14159265358979323846 : 1.0;
+  const double *restrict xr = x;
+  const double *restrict yr = y;
+  const double *restrict zr = z;
+  double *restrict tr = t;
+  double *restrict pr = p;
+  long i;
+
+# pragma omp simd
+  for ( i = 0; i < n; i++ )
+  {
+    double ang_x = atan2 ( yr[i], xr[i] );
+/*
+  XYZ_TO_TP takes ACOS(X) = pi/2 at the poles, and +pi on the negative
+  X axis whatever the sign of the zero Y.
+*/
+    ang_x = ( xr[i] == 0.0 && yr[i] == 0.0 ) ? half_pi : ang_x;
+    ang_x = ( yr[i] == 0.0 ) ? fabs ( ang_x ) : ang_x;
+
+    tr[i] = scale * ang_x;
+    pr[i] = scale * acos ( fmin ( fmax ( zr[i], -1.0 ), 1.0 ) );
+  }
+
+  return;
+}
+/******************************************************************************/
+
+int ld_spherical_by_order ( int order, double *t, double *p, int units )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    LD_SPHERICAL_BY_ORDER returns a Lebedev grid in spherical coordinates.
+
+  Discussion:
+
+    The points come straight from the compile-time tables of
+    LD_TABLE_BY_ORDER, converted by XYZ_TO_TP_BATCH; the weights are those
+    of LD_TABLE_BY_ORDER.
+
+  Parameters:
+
+    Input, int ORDER, the order of the rule.
+
+    Output, double T[ORDER], P[ORDER], the Theta and Phi coordinates of
+    the points.
+
+    Input, int UNITS, LEBEDEV_RADIANS or LEBEDEV_DEGREES.
+
+    Output, int LD_SPHERICAL_BY_ORDER, ORDER, or 0 if the rule is not
+    available or UNITS is invalid.
+*/
+{
+  const double *x, *y, *z, *w;
+  int n = 0;
+  LD_INSTRUMENT_BEGIN ( LD_SITE_SPHERICAL_BY_ORDER );
+
+  if ( ( units == LEBEDEV_RADIANS || units == LEBEDEV_DEGREES ) &&
+       ld_table_by_order ( order, &x, &y, &z, &w ) != 0 )
+  {
+    xyz_to_tp_batch ( order, x, y, z, t, p, units );
+    n = order;
+  }
+
+  LD_INSTRUMENT_END ( LD_SITE_SPHERICAL_BY_ORDER );
+  return n;
+}
@@ -0,0 +1,499 @@
+# include <algorithm>
+# include <cstddef>
+# include <cstdint>
+# include <initializer_list>
+
+# include "instrument.h"
+# include "lebedev-laikov.h"
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    Read-only Lebedev-Laikov grids, expanded at compile time.
+
+  Discussion:
+
+    The orbit generators of every LDNNNN routine of lebedev-laikov.c are
+    collected in lebedev-laikov-orbits.hpp (see
+    generate_lebedev_laikov_orbits.jl).  Here they are expanded with a
+    constexpr port of GEN_OH, so each grid lives in the read-only data
+    segment of the library and a lookup costs no arithmetic at all.
+
+    The points are produced in the same order as LD_BY_ORDER produces them.
+    For each order the X, Y, Z and W blocks are stored back to back, so the
+    coordinates can be read as a column-major ORDER x 3 matrix.
+
+    Requires C++17.
+*/
+namespace
+{
+
+struct Orbit
+{
+  int code;
+  double a;
+  double b;
+  double v;
+};
+
+# include "lebedev-laikov-orbits.hpp"
+
+template <int N>
+struct Rule
+{
+  double data[4*N];
+};
+
+/*
+  Square root by Newton iteration, so that it can be evaluated by the
+  compiler.  Only called with 0 <= s <= 1.
+*/
+constexpr double ct_sqrt ( double s )
+{
+  if ( s <= 0.0 )
+  {
+    return 0.0;
+  }
+  double r = 1.0;
+  for ( int i = 0; i < 100; i++ )
+  {
+    double next = 0.5 * ( r + s / r );
+    if ( next == r )
+    {
+      break;
+    }
+    r = next;
+  }
+  return r;
+}
+
+template <int N>
+constexpr void put ( Rule<N> &rule, int i, double x, double y, double z,
+  double v )
+{
+  rule.data[i]       = x;
+  rule.data[N+i]     = y;
+  rule.data[2*N+i]   = z;
+  rule.data[3*N+i]   = v;
+}
+
+/*
+  Same points, in the same order, as GEN_OH in lebedev-laikov.c.
+*/
+template <int N>
+constexpr int ct_gen_oh ( const Orbit &o, Rule<N> &r, int n )
+{
+  double a = o.a;
+  double b = o.b;
+  double c = 0.0;
+  double v = o.v;
+
+  if ( o.code == 1 )
+  {
+    a = 1.0;
+    put ( r, n+ 0,   a, 0.0, 0.0, v );
+    put ( r, n+ 1,  -a, 0.0, 0.0, v );
+    put ( r, n+ 2, 0.0,   a, 0.0, v );
+    put ( r, n+ 3, 0.0,  -a, 0.0, v );
+    put ( r, n+ 4, 0.0, 0.0,   a, v );
+    put ( r, n+ 5, 0.0, 0.0,  -a, v );
+    return 6;
+  }
+  else if ( o.code == 2 )
+  {
+    a = 1.0 / ct_sqrt ( 2.0 );
+    put ( r, n+ 0, 0.0,   a,   a, v );
+    put ( r, n+ 1, 0.0,   a,  -a, v );
+    put ( r, n+ 2, 0.0,  -a,   a, v );
+    put ( r, n+ 3, 0.0,  -a,  -a, v );
+    put ( r, n+ 4,   a, 0.0,   a, v );
+    put ( r, n+ 5,   a, 0.0,  -a, v );
+    put ( r, n+ 6,  -a, 0.0,   a, v );
+    put ( r, n+ 7,  -a, 0.0,  -a, v );
+    put ( r, n+ 8,   a,   a, 0.0, v );
+    put ( r, n+ 9,   a,  -a, 0.0, v );
+    put ( r, n+10,  -a,   a, 0.0, v );
+    put ( r, n+11,  -a,  -a, 0.0, v );
+    return 12;
+  }
+  else if ( o.code == 3 )
+  {
+    a = 1.0 / ct_sqrt ( 3.0 );
+    put ( r, n+ 0,   a,   a,   a, v );
+    put ( r, n+ 1,   a,   a,  -a, v );
+    put ( r, n+ 2,   a,  -a,   a, v );
+    put ( r, n+ 3,   a,  -a,  -a, v );
+    put ( r, n+ 4,  -a,   a,   a, v );
+    put ( r, n+ 5,  -a,   a,  -a, v );
+    put ( r, n+ 6,  -a,  -a,   a, v );
+    put ( r, n+ 7,  -a,  -a,  -a, v );
+    return 8;
+  }
+  else if ( o.code == 4 )
+  {
+    b = ct_sqrt ( 1.0 - 2.0 * a * a );
+    put ( r, n+ 0,   a,   a,   b, v );
+    put ( r, n+ 1,   a,   a,  -b, v );
+    put ( r, n+ 2,   a,  -a,   b, v );
+    put ( r, n+ 3,   a,  -a,  -b, v );
+    put ( r, n+ 4,  -a,   a,   b, v );
+    put ( r, n+ 5,  -a,   a,  -b, v );
+    put ( r, n+ 6,  -a,  -a,   b, v );
+    put ( r, n+ 7,  -a,  -a,  -b, v );
+    put ( r, n+ 8,   a,   b,   a, v );
+    put ( r, n+ 9,   a,  -b,   a, v );
+    put ( r, n+10,   a,   b,  -a, v );
+    put ( r, n+11,   a,  -b,  -a, v );
+    put ( r, n+12,  -a,   b,   a, v );
+    put ( r, n+13,  -a,  -b,   a, v );
+    put ( r, n+14,  -a,   b,  -a, v );
+    put ( r, n+15,  -a,  -b,  -a, v );
+    put ( r, n+16,   b,   a,   a, v );
+    put ( r, n+17,  -b,   a,   a, v );
+    put ( r, n+18,   b,   a,  -a, v );
+    put ( r, n+19,  -b,   a,  -a, v );
+    put ( r, n+20,   b,  -a,   a, v );
+    put ( r, n+21,  -b,  -a,   a, v );
+    put ( r, n+22,   b,  -a,  -a, v );
+    put ( r, n+23,  -b,  -a,  -a, v );
+    return 24;
+  }
+  else if ( o.code == 5 )
+  {
+    b = ct_sqrt ( 1.0 - a * a );
+    put ( r, n+ 0,   a,   b, 0.0, v );
+    put ( r, n+ 1,   a,  -b, 0.0, v );
+    put ( r, n+ 2,  -a,   b, 0.0, v );
+    put ( r, n+ 3,  -a,  -b, 0.0, v );
+    put ( r, n+ 4,   b,   a, 0.0, v );
+    put ( r, n+ 5,   b,  -a, 0.0, v );
+    put ( r, n+ 6,  -b,   a, 0.0, v );
+    put ( r, n+ 7,  -b,  -a, 0.0, v );
+    put ( r, n+ 8,   a, 0.0,   b, v );
+    put ( r, n+ 9,   a, 0.0,  -b, v );
+    put ( r, n+10,  -a, 0.0,   b, v );
+    put ( r, n+11,  -a, 0.0,  -b, v );
+    put ( r, n+12,   b, 0.0,   a, v );
+    put ( r, n+13,   b, 0.0,  -a, v );
+    put ( r, n+14,  -b, 0.0,   a, v );
+    put ( r, n+15,  -b, 0.0,  -a, v );
+    put ( r, n+16, 0.0,   a,   b, v );
+    put ( r, n+17, 0.0,   a,  -b, v );
+    put ( r, n+18, 0.0,  -a,   b, v );
+    put ( r, n+19, 0.0,  -a,  -b, v );
+    put ( r, n+20, 0.0,   b,   a, v );
+    put ( r, n+21, 0.0,   b,  -a, v );
+    put ( r, n+22, 0.0,  -b,   a, v );
+    put ( r, n+23, 0.0,  -b,  -a, v );
+    return 24;
+  }
+  else if ( o.code == 6 )
+  {
+    c = ct_sqrt ( 1.0 - a * a - b * b );
+    put ( r, n+ 0,   a,   b,   c, v );
+    put ( r, n+ 1,   a,   b,  -c, v );
+    put ( r, n+ 2,   a,  -b,   c, v );
+    put ( r, n+ 3,   a,  -b,  -c, v );
+    put ( r, n+ 4,  -a,   b,   c, v );
+    put ( r, n+ 5,  -a,   b,  -c, v );
+    put ( r, n+ 6,  -a,  -b,   c, v );
+    put ( r, n+ 7,  -a,  -b,  -c, v );
+    put ( r, n+ 8,   a,   c,   b, v );
+    put ( r, n+ 9,   a,   c,  -b, v );
+    put ( r, n+10,   a,  -c,   b, v );
+    put ( r, n+11,   a,  -c,  -b, v );
+    put ( r, n+12,  -a,   c,   b, v );
+    put ( r, n+13,  -a,   c,  -b, v );
+    put ( r, n+14,  -a,  -c,   b, v );
+    put ( r, n+15,  -a,  -c,  -b, v );
+    put ( r, n+16,   b,   a,   c, v );
+    put ( r, n+17,   b,   a,  -c, v );
+    put ( r, n+18,   b,  -a,   c, v );
+    put ( r, n+19,   b,  -a,  -c, v );
+    put ( r, n+20,  -b,   a,   c, v );
+    put ( r, n+21,  -b,   a,  -c, v );
+    put ( r, n+22,  -b,  -a,   c, v );
+    put ( r, n+23,  -b,  -a,  -c, v );
+    put ( r, n+24,   b,   c,   a, v );
+    put ( r, n+25,   b,   c,  -a, v );
+    put ( r, n+26,   b,  -c,   a, v );
+    put ( r, n+27,   b,  -c,  -a, v );
+    put ( r, n+28,  -b,   c,   a, v );
+    put ( r, n+29,  -b,   c,  -a, v );
+    put ( r, n+30,  -b,  -c,   a, v );
+    put ( r, n+31,  -b,  -c,  -a, v );
+    put ( r, n+32,   c,   a,   b, v );
+    put ( r, n+33,   c,   a,  -b, v );
+    put ( r, n+34,   c,  -a,   b, v );
+    put ( r, n+35,   c,  -a,  -b, v );
+    put ( r, n+36,  -c,   a,   b, v );
+    put ( r, n+37,  -c,   a,  -b, v );
+    put ( r, n+38,  -c,  -a,   b, v );
+    put ( r, n+39,  -c,  -a,  -b, v );
+    put ( r, n+40,   c,   b,   a, v );
+    put ( r, n+41,   c,   b,  -a, v );
+    put ( r, n+42,   c,  -b,   a, v );
+    put ( r, n+43,   c,  -b,  -a, v );
+    put ( r, n+44,  -c,   b,   a, v );
+    put ( r, n+45,  -c,   b,  -a, v );
+    put ( r, n+46,  -c,  -b,   a, v );
+    put ( r, n+47,  -c,  -b,  -a, v );
+    return 48;
+  }
+  return 0;
+}
+
+template <int N, std::size_t M>
+constexpr Rule<N> expand ( const Orbit ( &orbits )[M] )
+{
+  Rule<N> rule {};
+  int n = 0;
+  for ( std::size_t k = 0; k < M; k++ )
+  {
+    n = n + ct_gen_oh ( orbits[k], rule, n );
+  }
+  return rule;
+}
+
+/*
+  Orbits with their multiplicity and first point, for LD_ORBITS_BY_ORDER.
+*/
+template <std::size_t M>
+struct OrbitRule
+{
+  ld_orbit orbits[M];
+};
+
+template <std::size_t M>
+constexpr OrbitRule<M> compress ( const Orbit ( &orbits )[M] )
+{
+  OrbitRule<M> rule {};
+  for ( std::size_t k = 0; k < M; k++ )
+  {
+    Rule<48> points {};
+    int n = ct_gen_oh ( orbits[k], points, 0 );
+    rule.orbits[k] = { orbits[k].code, n,
+      points.data[0], points.data[48], points.data[96], orbits[k].v };
+  }
+  return rule;
+}
+
+# define LEBEDEV_RULE_TABLE(ORDER, NAME) \
+  constexpr Rule<ORDER> NAME##_table = expand<ORDER> ( NAME##_orbits ); \
+  constexpr auto NAME##_compressed = compress ( NAME##_orbits );
+LEBEDEV_LAIKOV_RULES(LEBEDEV_RULE_TABLE)
+# undef LEBEDEV_RULE_TABLE
+
+struct Entry
+{
+  int order;
+  const double *data;
+  int norbits;
+  const ld_orbit *orbits;
+};
+
+# define LEBEDEV_RULE_ENTRY(ORDER, NAME) \
+  { ORDER, NAME##_table.data, \
+    sizeof ( NAME##_orbits ) / sizeof ( Orbit ), NAME##_compressed.orbits },
+constexpr Entry entries[] = {
+  LEBEDEV_LAIKOV_RULES(LEBEDEV_RULE_ENTRY)
+};
+# undef LEBEDEV_RULE_ENTRY
+
+const Entry *lookup ( int order )
+{
+  for ( const Entry &e : entries )
+  {
+    if ( e.order == order )
+    {
+      return &e;
+    }
+  }
+  return nullptr;
+}
+
+}
+/******************************************************************************/
+
+int ld_table_by_order ( int order, const double **x, const double **y,
+  const double **z, const double **w )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    LD_TABLE_BY_ORDER looks up a precomputed Lebedev angular grid.
+
+  Discussion:
+
+    Same grids as LD_BY_ORDER, but nothing is computed or copied: the
+    pointers refer to static read-only storage that lives as long as the
+    library is loaded.  Y, Z and W follow X contiguously, i.e.
+    *Y == *X + ORDER, *Z == *X + 2*ORDER and *W == *X + 3*ORDER.
+
+  Parameters:
+
+    Input, int ORDER, the order of the rule.
+
+    Output, const double **X, **Y, **Z, **W, the coordinates and weights
+    of the points.  Left untouched if ORDER is not available.
+
+    Output, int LD_TABLE_BY_ORDER, the number of points, ORDER, or 0 if
+    there is no such rule in the table.
+*/
+{
+  LD_INSTRUMENT_SCOPE ( LD_SITE_TABLE_BY_ORDER );
+  const Entry *e = lookup ( order );
+
+  if ( e == nullptr )
+  {
+    return 0;
+  }
+  const double *data = e->data;
+  *x = data;
+  *y = data + order;
+  *z = data + 2 * order;
+  *w = data + 3 * order;
+
+  return order;
+}
+/******************************************************************************/
+
+int ld_padded_length ( int order, int width )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    LD_PADDED_LENGTH returns the padded length of a Lebedev angular grid.
+
+  Parameters:
+
+    Input, int ORDER, the order of the rule.
+
+    Input, int WIDTH, the vector width in doubles (e.g. 4 for AVX2, 8 for
+    AVX-512), a power of 2.
+
+    Output, int LD_PADDED_LENGTH, ORDER rounded up to a multiple of WIDTH,
+    or 0 if there is no such rule or WIDTH is not a power of 2.
+*/
+{
+  if ( width < 1 || ( width & ( width - 1 ) ) != 0 ||
+       lookup ( order ) == nullptr )
+  {
+    return 0;
+  }
+  return ( order + width - 1 ) & ~( width - 1 );
+}
+/******************************************************************************/
+
+int ld_by_order_padded ( int order, int width, double *x, double *y,
+  double *z, double *w )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    LD_BY_ORDER_PADDED copies a Lebedev angular grid into aligned, padded
+    arrays.
+
+  Discussion:
+
+    Meant for SIMD kernels that evaluate functions on the grid: with the
+    buffers aligned to LEBEDEV_ALIGNMENT bytes and their length a multiple
+    of WIDTH, loops need neither peeling nor remainder handling.
+
+    The padding points repeat the last point of the grid with zero weight,
+    so they stay on the unit sphere and any finite integrand evaluated there
+    contributes nothing (zero coordinates could produce 0/0 in angular
+    functions).
+
+    Nothing is computed: the points are copied from the compile-time tables.
+
+  Parameters:
+
+    Input, int ORDER, the order of the rule.
+
+    Input, int WIDTH, the vector width in doubles, a power of 2.
+
+    Output, double X[N], Y[N], Z[N], W[N], with N = LD_PADDED_LENGTH
+    ( ORDER, WIDTH ), the coordinates and weights of the points.  Each
+    array must be aligned to LEBEDEV_ALIGNMENT bytes.
+
+    Output, int LD_BY_ORDER_PADDED, the padded length N, or 0 if there is
+    no such rule, WIDTH is not a power of 2 or an array is misaligned.
+*/
+{
+  LD_INSTRUMENT_SCOPE ( LD_SITE_BY_ORDER_PADDED );
+  int n = ld_padded_length ( order, width );
+
+  if ( n == 0 )
+  {
+    return 0;
+  }
+  for ( const double *p : { x, y, z, w } )
+  {
+    if ( reinterpret_cast<std::uintptr_t> ( p ) % LEBEDEV_ALIGNMENT != 0 )
+    {
+      return 0;
+    }
+  }
+  const double *t = lookup ( order )->data;
+
+  std::copy ( t,             t +     order, x );
+  std::copy ( t +     order, t + 2 * order, y );
+  std::copy ( t + 2 * order, t + 3 * order, z );
+  std::copy ( t + 3 * order, t + 4 * order, w );
+
+  std::fill ( x + order, x + n, x[order-1] );
+  std::fill ( y + order, y + n, y[order-1] );
+  std::fill ( z + order, z + n, z[order-1] );
+  std::fill ( w + order, w + n, 0.0 );
+
+  return n;
+}
+/******************************************************************************/
+
+int ld_orbits_by_order ( int order, const ld_orbit **orbits )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    LD_ORBITS_BY_ORDER returns a Lebedev angular grid in compressed form.
+
+  Discussion:
+
+    Every Lebedev grid is a union of orbits of the octahedral group OH,
+    each one generated by a GEN_OH call.  For an integrand with OH symmetry
+    all the points of an orbit give the same value, so
+      sum ( multiplicity[k] * w[k] * f ( x[k], y[k], z[k] ) )
+    over the orbits equals the sum over the full grid, with 6 to 48 times
+    fewer evaluations.
+
+    Orbits are listed in the order in which LD_BY_ORDER generates them;
+    the point stored with each orbit is the first one GEN_OH generates.
+    The table is static and read-only, like that of LD_TABLE_BY_ORDER.
+
+  Parameters:
+
+    Input, int ORDER, the order of the rule.
+
+    Output, const ld_orbit **ORBITS, the orbits.  Left untouched if ORDER
+    is not available.
+
+    Output, int LD_ORBITS_BY_ORDER, the number of orbits, or 0 if there is
+    no such rule in the table.
+*/
+{
+  const Entry *e = lookup ( order );
+
+  if ( e == nullptr )
+  {
+    return 0;
+  }
+  *orbits = e->orbits;
+
+  return e->norbits;
+}
@@ -3,6 +3,7 @@
 # include <math.h>
 # include <time.h>
 
+# include "instrument.h"
 # include "lebedev-laikov.h"
 
 # define NMAX 65
@@ -128,7 +129,8 @@ int gen_oh ( int code, double a, double b, double v, double *x, double *y,
     Output, double X[NUM], Y[NUM], Z[NUM], W[NUM], the coordinates
     and weights of the symmetric points generated on this call.
 
-    Output, int GEN_OH, the number of points generated by this call.
+    Output, int GEN_OH, the number of points generated by this call, 0 for
+    an illegal value of CODE.
 */
 {
   double c;
@@ -288,16 +290,13 @@ int gen_oh ( int code, double a, double b, double v, double *x, double *y,
   }
   else
   {
-    fprintf ( stderr, "\n" );
-    fprintf ( stderr, "GEN_OH - Fatal error!\n" );
-    fprintf ( stderr, "  Illegal value of code.\n" );
-    exit ( 1 );
+    n = 0;
   }
   return n;
 }
 /******************************************************************************/
 
-void ld_by_order ( int order, double *x, double *y, double *z, double *w )
+int ld_by_order ( int order, double *x, double *y, double *z, double *w )
 
 /******************************************************************************/
 /*
@@ -308,6 +307,7 @@ void ld_by_order ( int order, double *x, double *y, double *z, double *w )
   Discussion:
 
     Only a certain set of such rules are available through this function.
+    LEBEDEV_NEAREST_ORDER and LEBEDEV_BY_PRECISION find one of them.
 
   Modified:
 
@@ -331,8 +331,14 @@ void ld_by_order ( int order, double *x, double *y, double *z, double *w )
 
     Output, double X[ORDER], Y[ORDER], Z[ORDER], W[ORDER], the coordinates
     and weights of the points.
+
+    Output, int LD_BY_ORDER, LEBEDEV_SUCCESS, or LEBEDEV_EINVAL if there is
+    no rule of that order (X, Y, Z and W are left untouched).
 */
 {
+  int status = LEBEDEV_SUCCESS;
+  LD_INSTRUMENT_BEGIN ( LD_SITE_BY_ORDER );
+
   if ( order == 6 )
   {
     ld0006 ( x, y, z, w );
@@ -463,13 +469,11 @@ void ld_by_order ( int order, double *x, double *y, double *z, double *w )
   }
   else
   {
-    fprintf ( stderr, "\n" );
-    fprintf ( stderr, "LD_BY_ORDER - Fatal error!\n" );
-    fprintf ( stderr, "  Unexpected value of ORDER.\n" );
-    exit ( 1 );
+    status = LEBEDEV_EINVAL;
   }
 
-  return;
+  LD_INSTRUMENT_END ( LD_SITE_BY_ORDER );
+  return status;
 }
 /******************************************************************************/
 
@@ -6321,6 +6325,128 @@ void ld5810 ( double *x, double *y, double *z, double *w )
 }
 /******************************************************************************/
 
+int lebedev_by_precision ( int precision, int *order )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    LEBEDEV_BY_PRECISION returns the smallest available rule of a precision.
+
+  Discussion:
+
+    The rule of index RULE integrates exactly all spherical harmonics up to
+    degree 2 * RULE + 1, so the lowest rule that reaches PRECISION is found
+    directly; at most two unavailable rules have to be skipped after it.
+
+  Parameters:
+
+    Input, int PRECISION, the requested precision, the degree of the
+    spherical harmonics to be integrated exactly.
+
+    Output, int *ORDER, the order of the smallest available rule with at
+    least that precision.  Left untouched on error.
+
+    Output, int LEBEDEV_BY_PRECISION, LEBEDEV_SUCCESS, or LEBEDEV_EINVAL if
+    no available rule is that precise (PRECISION > 131).
+*/
+{
+  int rule;
+
+  if ( precision < 3 )
+  {
+    precision = 3;
+  }
+  rule = ( precision - 1 ) / 2;
+  if ( precision_table ( rule ) < precision )
+  {
+    rule = rule + 1;
+  }
+  while ( available_table ( rule ) == 0 )
+  {
+    rule = rule + 1;
+  }
+  if ( available_table ( rule ) != 1 )
+  {
+    return LEBEDEV_EINVAL;
+  }
+  *order = order_table ( rule );
+
+  return LEBEDEV_SUCCESS;
+}
+/******************************************************************************/
+
+int lebedev_nearest_order ( int n, int *order )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    LEBEDEV_NEAREST_ORDER returns the available order closest to N.
+
+  Discussion:
+
+    When N lies halfway between two available orders the smallest one is
+    chosen.  The available orders are a fixed sorted list, so this is a
+    binary search of at most 5 steps.
+
+  Parameters:
+
+    Input, int N, the desired number of points.
+
+    Output, int *ORDER, the order of the closest available rule, which can
+    be passed to LD_BY_ORDER.
+
+    Output, int LEBEDEV_NEAREST_ORDER, LEBEDEV_SUCCESS.
+*/
+{
+  static const int available[32] = {
+      6,   14,   26,   38,   50,   74,   86,  110,  146,  170,
+    194,  230,  266,  302,  350,  434,  590,  770,  974, 1202,
+   1454, 1730, 2030, 2354, 2702, 3074, 3470, 3890, 4334, 4802,
+   5294, 5810 };
+  int hi = 31;
+  int lo = 0;
+  int mid;
+
+  if ( n <= available[lo] )
+  {
+    *order = available[lo];
+    return LEBEDEV_SUCCESS;
+  }
+  if ( available[hi] <= n )
+  {
+    *order = available[hi];
+    return LEBEDEV_SUCCESS;
+  }
+/*
+  Keep available[lo] < N <= available[hi].
+*/
+  while ( 1 < hi - lo )
+  {
+    mid = ( lo + hi ) / 2;
+    if ( available[mid] < n )
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  if ( available[hi] - n < n - available[lo] )
+  {
+    *order = available[hi];
+  }
+  else
+  {
+    *order = available[lo];
+  }
+
+  return LEBEDEV_SUCCESS;
+}
+/******************************************************************************/
+
 int order_table ( int rule )
 
 /******************************************************************************/
@@ -6349,7 +6475,8 @@ int order_table ( int rule )
 
     Input, int RULE, the index of the rule, between 1 and 65.
 
-    Output, int ORDER_TABLE, the order of the rule.
+    Output, int ORDER_TABLE, the order of the rule, or -1 if there is no
+    such rule.
 */
 {
   int rule_max = 65;
@@ -6363,23 +6490,15 @@ int order_table ( int rule )
    5090, 5294, 5438, 5606, 5810 };
   int value;
 
-  if ( rule < 1 )
+  if ( rule < 1 || rule_max < rule )
   {
-    fprintf ( stderr, "\n" );
-    fprintf ( stderr, "ORDER_TABLE - Fatal error!\n" );
-    fprintf ( stderr, "  RULE < 1.\n" );
-    exit ( 1 );
+    value = - 1;
   }
-  else if ( rule_max < rule )
+  else
   {
-    fprintf ( stderr, "\n" );
-    fprintf ( stderr, "ORDER_TABLE - Fatal error!\n" );
-    fprintf ( stderr, "  RULE_MAX < RULE.\n" );
-    exit ( 1 );
+    value = table[rule-1];
   }
 
-  value = table[rule-1];
-
   return value;
 }
 /******************************************************************************/
@@ -6412,7 +6531,8 @@ int precision_table ( int rule )
 
     Input, int RULE, the index of the rule, between 1 and 65.
 
-    Output, int PRECISION_TABLE, the precision of the rule.
+    Output, int PRECISION_TABLE, the precision of the rule, or -1 if there
+    is no such rule.
 */
 {
   int rule_max = 65;
@@ -6426,23 +6546,15 @@ int precision_table ( int rule )
    123, 125, 127, 129, 131 };
   int value;
 
-  if ( rule < 1 )
+  if ( rule < 1 || rule_max < rule )
   {
-    fprintf ( stderr, "\n" );
-    fprintf ( stderr, "PRECISION_TABLE - Fatal error!\n" );
-    fprintf ( stderr, "  RULE < 1.\n" );
-    exit ( 1 );
+    value = - 1;
   }
-  else if ( rule_max < rule )
+  else
   {
-    fprintf ( stderr, "\n" );
-    fprintf ( stderr, "PRECISION_TABLE - Fatal error!\n" );
-    fprintf ( stderr, "  RULE_MAX < RULE.\n" );
-    exit ( 1 );
+    value = table[rule-1];
   }
 
-  value = table[rule-1];
-
   return value;
 }
 /******************************************************************************/
@@ -1,7 +1,38 @@
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/* Status codes */
+# define LEBEDEV_SUCCESS  0
+# define LEBEDEV_EINVAL  -1
+
+/* Alignment in bytes required by LD_BY_ORDER_PADDED (a cache line) */
+# define LEBEDEV_ALIGNMENT 64
+
+/* Angle units of XYZ_TO_TP_BATCH and LD_SPHERICAL_BY_ORDER */
+# define LEBEDEV_RADIANS  0
+# define LEBEDEV_DEGREES  1
+
+/* An orbit of a Lebedev grid under OH symmetry, see LD_ORBITS_BY_ORDER */
+typedef struct
+{
+  int code;          /* GEN_OH code, 1 to 6 */
+  int multiplicity;  /* number of points of the orbit, 6 to 48 */
+  double x, y, z;    /* first point of the orbit */
+  double w;          /* weight of every point of the orbit */
+} ld_orbit;
+
 int available_table ( int rule );
 int gen_oh ( int code, double a, double b, double v, double *x, double *y,
              double *z, double *w );
-void ld_by_order ( int order, double *x, double *y, double *z, double *w );
+int ld_by_order ( int order, double *x, double *y, double *z, double *w );
+int ld_by_order_padded ( int order, int width, double *x, double *y,
+                         double *z, double *w );
+int ld_orbits_by_order ( int order, const ld_orbit **orbits );
+int ld_padded_length ( int order, int width );
+int ld_spherical_by_order ( int order, double *t, double *p, int units );
+int ld_table_by_order ( int order, const double **x, const double **y,
+                        const double **z, const double **w );
 void ld0006 ( double *x, double *y, double *z, double *w );
 void ld0014 ( double *x, double *y, double *z, double *w );
 void ld0026 ( double *x, double *y, double *z, double *w );
@@ -34,7 +65,15 @@ void ld4334 ( double *x, double *y, double *z, double *w );
 void ld4802 ( double *x, double *y, double *z, double *w );
 void ld5294 ( double *x, double *y, double *z, double *w );
 void ld5810 ( double *x, double *y, double *z, double *w );
+int lebedev_by_precision ( int precision, int *order );
+int lebedev_nearest_order ( int n, int *order );
 int order_table ( int rule );
 int precision_table ( int rule );
 void timestamp ( void );
 void xyz_to_tp ( double x, double y, double z, double *t, double *p );
+void xyz_to_tp_batch ( long n, const double *x, const double *y,
+                       const double *z, double *t, double *p, int units );
+
+# ifdef __cplusplus
+}
+# endif
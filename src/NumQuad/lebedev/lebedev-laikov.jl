@@ -1,64 +1,283 @@
 
-#using Libdl
-#push!(Libdl.DL_LOAD_PATH, @__DIR__)
+import Libdl
+
+# Optimised library built by CMakeLists.txt (run build.sh), or any other
+# prebuilt copy given by SCIALGS_LIBLEBEDEV
+const LIBLEBEDEV_PREBUILT = get(ENV, "SCIALGS_LIBLEBEDEV",
+                                joinpath(@__DIR__, "build", "lib", "liblebedev." * Libdl.dlext))
 
-const LIBLEBEDEV    = joinpath(@__DIR__, "lebedev-laikov.so")
 LEBEDEVSOURCE = joinpath(@__DIR__, "lebedev-laikov.c")
 LEBEDEVHEADER = joinpath(@__DIR__, "lebedev-laikov.h")
+LEBEDEVTABLE  = joinpath(@__DIR__, "lebedev-laikov-table.cpp")
+LEBEDEVORBITS = joinpath(@__DIR__, "lebedev-laikov-orbits.hpp")
+# Vectorised with libmvec, built with its own flags (see CMakeLists.txt)
+LEBEDEVSPHERICAL = joinpath(@__DIR__, "lebedev-laikov-spherical.c")
+# C++ sources built into the same library
+LEBEDEVCXX    = [LEBEDEVTABLE,
+                 joinpath(@__DIR__, "grid-cache.cpp"),
+                 joinpath(@__DIR__, "molecular-grid.cpp"),
+                 joinpath(@__DIR__, "instrument.cpp"),
+                 joinpath(@__DIR__, "reductions.cpp")]
+LEBEDEVDEPS   = [LEBEDEVSOURCE, LEBEDEVHEADER, LEBEDEVORBITS, LEBEDEVSPHERICAL, LEBEDEVCXX...,
+                 joinpath(@__DIR__, "molecular-grid.h"), joinpath(@__DIR__, "instrument.h"),
+                 joinpath(@__DIR__, "reductions.h")]
 
-# Compile Lebedev-Laikov routine as a shared library
-if !isfile(LIBLEBEDEV) ||
-   mtime(LEBEDEVSOURCE) > mtime(LIBLEBEDEV) ||
-   mtime(LEBEDEVHEADER) > mtime(LIBLEBEDEV)
+if isfile(LIBLEBEDEV_PREBUILT)
 
-   run(`gcc -shared -fPIC -o $LIBLEBEDEV $LEBEDEVSOURCE`)
-end
+   const LIBLEBEDEV = LIBLEBEDEV_PREBUILT
+   if any(mtime(dep) > mtime(LIBLEBEDEV) for dep in LEBEDEVDEPS)
+      @warn "$LIBLEBEDEV is older than its sources; rerun build.sh"
+   end
+else
 
-function lebedev_laikov_wrapper(nang_pts::Int)
+   const LIBLEBEDEV = joinpath(@__DIR__, "lebedev-laikov.so")
 
-   valid_orders = [6,    14,   26,   38,   50,   74,   86,   110,  146,  170,  194,
-                   230,  266,  302,  350,  434,  590,  770,  974,  1202, 1454, 1730,
-                   2030, 2354, 2702, 3074, 3470, 3890, 4334, 4802, 5294, 5810]
+   # Compile Lebedev-Laikov routine as a shared library
+   if !isfile(LIBLEBEDEV) || any(mtime(dep) > mtime(LIBLEBEDEV) for dep in LEBEDEVDEPS)
 
-   # Interpolation to closest valid order; if unique choose smallest
-   valid_nang_pts = valid_orders[argmin(abs.(nang_pts .- valid_orders))]
-   if valid_nang_pts != nang_pts 
-      @debug "Number of angular grid points changed: $nang_pts -> $valid_nang_pts"
+      # The grid tables are expanded by the C++ compiler (constexpr)
+      object = tempname() * ".o"
+      spherical = tempname() * ".o"
+      run(`gcc -O2 -c -fPIC -o $object $LEBEDEVSOURCE`)
+      run(`gcc -O2 -ffast-math -fopenmp-simd -c -fPIC -o $spherical $LEBEDEVSPHERICAL`)
+      run(`g++ -O2 -std=c++17 -fopenmp -shared -fPIC -o $LIBLEBEDEV $LEBEDEVCXX $object $spherical`)
+      rm(object)
+      rm(spherical)
    end
+end
 
-   @assert valid_nang_pts ∈ valid_orders
+# Lebedev-Laikov grid of order n straight from the tables compiled into
+# LIBLEBEDEV: no computation and no copies. The n×3 points matrix [x y z]
+# and the weights alias static read-only memory, so they must not be
+# modified (copy them first).
+function lebedev_laikov_table(n::Int)
 
-   x       = zeros(valid_nang_pts)
-   y       = zeros(valid_nang_pts)
-   z       = zeros(valid_nang_pts)
-   weights = zeros(valid_nang_pts)
+   x = Ref{Ptr{Float64}}(C_NULL)
+   y = Ref{Ptr{Float64}}(C_NULL)
+   z = Ref{Ptr{Float64}}(C_NULL)
+   w = Ref{Ptr{Float64}}(C_NULL)
 
    @static if VERSION >= v"1.5.0"
 
-      @ccall LIBLEBEDEV.ld_by_order(
-         valid_nang_pts :: Int,
-         x              :: Ref{Float64},
-         y              :: Ref{Float64},
-         z              :: Ref{Float64},
-         weights        :: Ref{Float64}
+      npts = @ccall LIBLEBEDEV.ld_table_by_order(
+         n :: Cint,
+         x :: Ref{Ptr{Float64}},
+         y :: Ref{Ptr{Float64}},
+         z :: Ref{Ptr{Float64}},
+         w :: Ref{Ptr{Float64}}
       )::Cint
    else
 
-      ccall((:ld_by_order, LIBLEBEDEV),
-         Int,
-         (Int, Ref{Float64}, Ref{Float64}, Ref{Float64}, Ref{Float64}),
-         valid_nang_pts, x, y, z, weights)
+      npts = ccall((:ld_table_by_order, LIBLEBEDEV),
+         Cint,
+         (Cint, Ref{Ptr{Float64}}, Ref{Ptr{Float64}}, Ref{Ptr{Float64}}, Ref{Ptr{Float64}}),
+         n, x, y, z, w)
+   end
+
+   npts == n || error("No Lebedev-Laikov rule with $n points")
+
+   # y and z follow x contiguously, see lebedev-laikov-table.cpp
+   unsafe_wrap(Array, x[], (n, 3)), unsafe_wrap(Array, w[], n)
+end
+
+# Orbit of a Lebedev grid under octahedral symmetry (ld_orbit in
+# lebedev-laikov.h): `multiplicity` points with the same weight `w`, of
+# which (x, y, z) is the first one.
+struct LebedevOrbit
+   code::Cint
+   multiplicity::Cint
+   x::Float64
+   y::Float64
+   z::Float64
+   w::Float64
+end
+
+# Lebedev-Laikov grid of order n as its list of orbits, for integrands with
+# octahedral symmetry:
+#    ∫ f dΩ/4π ≈ sum(o.multiplicity * o.w * f(o.x, o.y, o.z) for o in orbits)
+# The vector aliases static read-only memory, like lebedev_laikov_table.
+function lebedev_laikov_orbits(n::Int)
+
+   orbits = Ref{Ptr{LebedevOrbit}}(C_NULL)
+   norbits = ccall((:ld_orbits_by_order, LIBLEBEDEV), Cint,
+                   (Cint, Ref{Ptr{LebedevOrbit}}),
+                   n, orbits)
+   norbits == 0 && error("No Lebedev-Laikov rule with $n points")
+
+   unsafe_wrap(Array, orbits[], norbits)
+end
+
+# Vector of n Float64 aligned to `alignment` bytes, freed by the GC
+function _aligned_vector(n, alignment)
+   p = Ref{Ptr{Cvoid}}(C_NULL)
+   status = ccall(:posix_memalign, Cint, (Ref{Ptr{Cvoid}}, Csize_t, Csize_t),
+                  p, alignment, max(n, 1) * sizeof(Float64))
+   status == 0 || throw(OutOfMemoryError())
+   unsafe_wrap(Array, Ptr{Float64}(p[]), n, own=true)
+end
+
+# Lebedev-Laikov grid of order n in 64-byte aligned x, y, z, w vectors whose
+# length is rounded up to a multiple of the SIMD width (in Float64s), so
+# kernels need no remainder loop. The padding repeats the last point with
+# zero weight.
+function lebedev_laikov_padded(n::Int; width::Int = 8)
+
+   len = ccall((:ld_padded_length, LIBLEBEDEV), Cint, (Cint, Cint), n, width)
+   len == 0 && error("No Lebedev-Laikov rule with $n points or invalid width $width")
+
+   alignment = 64 # LEBEDEV_ALIGNMENT
+   x, y, z, w = (_aligned_vector(len, alignment) for _ in 1:4)
+
+   ccall((:ld_by_order_padded, LIBLEBEDEV), Cint,
+         (Cint, Cint, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}),
+         n, width, x, y, z, w) == len || error("Could not fill the padded grid")
+
+   x, y, z, w
+end
+
+# Closest available Lebedev-Laikov order to n; the smallest one on ties
+function lebedev_nearest_order(n::Integer)
+   order = Ref{Cint}(0)
+   ccall((:lebedev_nearest_order, LIBLEBEDEV), Cint, (Cint, Ref{Cint}), n, order)
+   Int(order[])
+end
+
+# Order of the smallest available Lebedev-Laikov rule that integrates
+# spherical harmonics up to degree `precision` exactly
+function lebedev_order_by_precision(precision::Integer)
+   order = Ref{Cint}(0)
+   status = ccall((:lebedev_by_precision, LIBLEBEDEV), Cint, (Cint, Ref{Cint}),
+                  precision, order)
+   status == 0 || error("No Lebedev-Laikov rule of precision $precision")
+   Int(order[])
+end
+
+function lebedev_laikov_wrapper(nang_pts::Int)
+
+   # Interpolation to closest valid order; if unique choose smallest
+   valid_nang_pts = lebedev_nearest_order(nang_pts)
+   if valid_nang_pts != nang_pts 
+      @debug "Number of angular grid points changed: $nang_pts -> $valid_nang_pts"
    end
 
-   @assert sum(weights) ≈ 1 # as a test?
+   # Own copies, so callers are free to modify them
+   points, weights = lebedev_laikov_table(valid_nang_pts)
+   points, weights = copy(points), copy(weights)
+
+   @assert grid_integrate(weights) ≈ 1 # as a test?
+
+   points, weights
+end
+
+# Compensated reductions of reductions.cpp, spread over `nthreads` OpenMP
+# threads (0: OMP_NUM_THREADS) and reproducible to the last bit for any
+# number of threads
+function reproducible_sum(x::Vector{Float64}; nthreads::Integer = 0)
+   ccall((:ld_sum, LIBLEBEDEV), Cdouble, (Clong, Ptr{Float64}, Cint),
+         length(x), x, nthreads)
+end
+
+function reproducible_dot(x::Vector{Float64}, y::Vector{Float64}; nthreads::Integer = 0)
+   length(x) == length(y) || throw(DimensionMismatch("x and y must have the same length"))
+   ccall((:ld_dot, LIBLEBEDEV), Cdouble, (Clong, Ptr{Float64}, Ptr{Float64}, Cint),
+         length(x), x, y, nthreads)
+end
+
+function reproducible_norm(x::Vector{Float64}; nthreads::Integer = 0)
+   ccall((:ld_norm, LIBLEBEDEV), Cdouble, (Clong, Ptr{Float64}, Cint),
+         length(x), x, nthreads)
+end
+
+# Quadrature sum(w .* f) over a grid with weights w, or sum(w) without f,
+# with the same guarantees
+function grid_integrate(w::Vector{Float64}, f::Union{Vector{Float64},Nothing} = nothing;
+                        nthreads::Integer = 0)
+   f === nothing || length(f) == length(w) ||
+      throw(DimensionMismatch("w and f must have the same length"))
+   ccall((:ld_integrate, LIBLEBEDEV), Cdouble, (Clong, Ptr{Float64}, Ptr{Float64}, Cint),
+         length(w), w, f === nothing ? C_NULL : f, nthreads)
+end
+
+const LEBEDEV_RADIANS = 0
+const LEBEDEV_DEGREES = 1
 
-   [x y z], weights
+# Spherical angles of the points on the unit sphere given as the rows of
+# the n×3 matrix `points`, written into θ (azimuth, in (-π, π]) and ϕ
+# (polar angle, in [0, π]) in one vectorised call; same conventions as
+# cart2spherical.
+function lebedev_xyz_to_tp!(θ::Vector{Float64}, ϕ::Vector{Float64},
+                            points::Matrix{Float64}; degrees::Bool = false)
+
+   n = size(points, 1)
+   size(points, 2) == 3 || error("Must be Npoints × 3 matrix")
+   length(θ) == length(ϕ) == n || error("θ and ϕ must have $n elements")
+
+   GC.@preserve points ccall((:xyz_to_tp_batch, LIBLEBEDEV), Cvoid,
+      (Clong, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}, Cint),
+      n, pointer(points, 1), pointer(points, n + 1), pointer(points, 2n + 1),
+      θ, ϕ, degrees ? LEBEDEV_DEGREES : LEBEDEV_RADIANS)
+
+   θ, ϕ
+end
+
+# Lebedev-Laikov grid of the closest order to n in spherical coordinates,
+# converted natively from the compile-time tables
+function lebedev_laikov_spherical(n; degrees::Bool = false)
+
+   order = lebedev_nearest_order(n)
+   θ, ϕ = zeros(order), zeros(order)
+
+   ccall((:ld_spherical_by_order, LIBLEBEDEV), Cint,
+         (Cint, Ptr{Float64}, Ptr{Float64}, Cint),
+         order, θ, ϕ, degrees ? LEBEDEV_DEGREES : LEBEDEV_RADIANS) == order ||
+      error("No Lebedev-Laikov rule with $order points")
+
+   _, weights = lebedev_laikov_table(order)
+   θ, ϕ, copy(weights)
 end
 
-using SciAlgs: cart2spherical
+# Instrumentation of the entry points of LIBLEBEDEV (instrument.h), compiled
+# in by building with -DLEBEDEV_INSTRUMENT=ON; otherwise every count is 0
+const LEBEDEV_SUCCESS = 0
 
-function lebedev_laikov_spherical(n)
-   points, weights = lebedev_laikov_wrapper(n)
-   θ, ϕ = cart2spherical(points)
-   θ, ϕ, weights
+struct LdInstrumentStats
+   name::Cstring
+   calls::Clong
+   seconds::Cdouble
+   cycles::Culonglong
+   histogram::NTuple{32,Clong}
+end
+
+lebedev_instrument_enabled() = ccall((:ld_instrument_enabled, LIBLEBEDEV), Cint, ()) == 1
+
+# Per function, over all threads: calls, wall time, time stamp counter cycles
+# and histogram[b+1], the calls that took 2^b ≤ ns < 2^(b+1)
+function lebedev_instrument_stats()
+   stats = NamedTuple{(:name, :calls, :seconds, :cycles, :histogram),
+                      Tuple{String,Int,Float64,UInt64,Vector{Int}}}[]
+   s = Ref{LdInstrumentStats}()
+   site = 0
+   while ccall((:ld_instrument_get, LIBLEBEDEV), Cint,
+               (Cint, Ref{LdInstrumentStats}), site, s) == LEBEDEV_SUCCESS
+      push!(stats, (name = unsafe_string(s[].name), calls = Int(s[].calls),
+                    seconds = s[].seconds, cycles = UInt64(s[].cycles),
+                    histogram = collect(Int, s[].histogram)))
+      site += 1
+   end
+   stats
+end
+
+lebedev_instrument_reset() = ccall((:ld_instrument_reset, LIBLEBEDEV), Cvoid, ())
+
+# Run f() recording a Chrome trace (chrome://tracing, ui.perfetto.dev) of the
+# native calls to `path`
+function lebedev_trace(f, path::AbstractString)
+   ccall((:ld_instrument_trace, LIBLEBEDEV), Cint, (Cstring,), path) == LEBEDEV_SUCCESS ||
+      error("Could not start tracing")
+   try
+      f()
+   finally
+      ccall((:ld_instrument_trace, LIBLEBEDEV), Cint, (Ptr{Cchar},), C_NULL) == LEBEDEV_SUCCESS ||
+         error("Could not write $path")
+   end
 end
@@ -0,0 +1,610 @@
+# include <cmath>
+# include <new>
+# include <vector>
+
+# include "instrument.h"
+# include "lebedev-laikov.h"
+# include "molecular-grid.h"
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    Molecular integration grids: radial x Lebedev grids on every atom,
+    weighted by an atomic partition, generated in a single call.
+
+  Discussion:
+
+    The atomic grids come from the cache of grid-cache.cpp (radial rules
+    mapped to [0,oo) with Becke's transformation, times the compile-time
+    Lebedev tables) and are scaled by RM: r = rm (1+x)/(1-x).
+
+    Pruned grids have a Lebedev order per radial shell instead of per
+    atom, usually low near the nucleus and far out where the density is
+    nearly spherical, and high in the valence region.  PRUNED_ORDERS picks
+    the orders from a partition of the radial range into regions of given
+    precision (SG-1 style), and PRUNED_MOLECULAR_GRID emits the grid.
+    Pruned atomic grids depend on more than (order, scheme, shells), so
+    they are built per call rather than cached.
+
+    Atoms are processed in parallel when compiled with OpenMP.
+
+  Reference:
+
+    Peter Gill, Benny Johnson, John Pople,
+    A standard grid for density functional calculations,
+    Chemical Physics Letters,
+    Volume 209, Number 5-6, 1993, pages 506-512.
+
+    Axel Becke,
+    A multicenter numerical integration scheme for polyatomic molecules,
+    Journal of Chemical Physics,
+    Volume 88, Number 4, 1988, pages 2547-2553.
+*/
+namespace
+{
+
+const double pi = 3.14159265358979323846;
+
+/*
+  Becke's fuzzy cell weight of ATOM at a point, given the distances DIST
+  from the point to every atom and the inverse interatomic distances RINV.
+*/
+double becke_weight ( int natoms, int atom, const double *dist,
+  const double *rinv )
+{
+  double num = 0.0;
+  double den = 0.0;
+
+  for ( int i = 0; i < natoms; i++ )
+  {
+    double cell = 1.0;
+    for ( int j = 0; j < natoms && cell > 0.0; j++ )
+    {
+      if ( j == i )
+      {
+        continue;
+      }
+      double mu = ( dist[i] - dist[j] ) * rinv[i*natoms+j];
+      for ( int k = 0; k < 3; k++ )
+      {
+        mu = 1.5 * mu - 0.5 * mu * mu * mu;
+      }
+      cell = cell * 0.5 * ( 1.0 - mu );
+    }
+    den = den + cell;
+    if ( i == atom )
+    {
+      num = cell;
+    }
+  }
+  return 0.0 < den ? num / den : 0.0;
+}
+
+/*
+  The nuclei of a molecule and, for Becke's partition, their inverse
+  distances.
+*/
+struct Nuclei
+{
+  int natoms;
+  const double *ax, *ay, *az;
+  int partition;
+  std::vector<double> rinv;
+};
+
+/*
+  Returns 0, or MOLECULAR_GRID_EINVAL if two nuclei coincide.
+*/
+int nuclei_setup ( Nuclei &nuclei, int natoms, const double *coords,
+  int partition )
+{
+  const double *ax = coords;
+  const double *ay = coords + natoms;
+  const double *az = coords + 2 * natoms;
+
+  nuclei.natoms = natoms;
+  nuclei.ax = ax;
+  nuclei.ay = ay;
+  nuclei.az = az;
+  nuclei.partition = partition;
+
+  if ( partition == MOLECULAR_GRID_BECKE )
+  {
+    nuclei.rinv.resize ( ( size_t ) natoms * natoms, 0.0 );
+    for ( int i = 0; i < natoms; i++ )
+    {
+      for ( int j = 0; j < natoms; j++ )
+      {
+        if ( i == j )
+        {
+          continue;
+        }
+        double r = sqrt ( ( ax[i] - ax[j] ) * ( ax[i] - ax[j] )
+                        + ( ay[i] - ay[j] ) * ( ay[i] - ay[j] )
+                        + ( az[i] - az[j] ) * ( az[i] - az[j] ) );
+        if ( r == 0.0 )
+        {
+          return MOLECULAR_GRID_EINVAL;
+        }
+        nuclei.rinv[i*natoms+j] = 1.0 / r;
+      }
+    }
+  }
+  return 0;
+}
+
+/*
+  Moves the N points of a grid at the origin (UX, UY, UZ, UW) to atom A,
+  scaled by SCALE and weighted by the partition, into X, Y, Z and W.
+  DIST is a scratch array of NATOMS.
+*/
+void place_atom ( const Nuclei &nuclei, int a, double scale, long n,
+  const double *ux, const double *uy, const double *uz, const double *uw,
+  double *dist, double *x, double *y, double *z, double *w )
+{
+  const double *ax = nuclei.ax;
+  const double *ay = nuclei.ay;
+  const double *az = nuclei.az;
+  double volume = scale * scale * scale;
+
+  for ( long j = 0; j < n; j++ )
+  {
+    double px = ax[a] + scale * ux[j];
+    double py = ay[a] + scale * uy[j];
+    double pz = az[a] + scale * uz[j];
+    double wp = volume * uw[j];
+
+    if ( nuclei.partition == MOLECULAR_GRID_BECKE )
+    {
+      for ( int b = 0; b < nuclei.natoms; b++ )
+      {
+        dist[b] = sqrt ( ( px - ax[b] ) * ( px - ax[b] )
+                       + ( py - ay[b] ) * ( py - ay[b] )
+                       + ( pz - az[b] ) * ( pz - az[b] ) );
+      }
+      wp = wp * becke_weight ( nuclei.natoms, a, dist, nuclei.rinv.data ( ) );
+    }
+
+    x[j] = px;
+    y[j] = py;
+    z[j] = pz;
+    w[j] = wp;
+  }
+}
+
+/*
+  Grid of an atom at the origin with the Lebedev order NANG[i] on shell i
+  of RADIAL_GRID ( RADIAL, NRAD ), into the X, Y, Z and W blocks of U.
+  The orders must have been checked.
+*/
+void pruned_atom ( int radial, int nrad, const int *nang,
+  std::vector<double> &r, std::vector<double> &wr, std::vector<double> &u )
+{
+  long n = 0;
+  for ( int i = 0; i < nrad; i++ )
+  {
+    n = n + nang[i];
+  }
+  r.resize ( nrad );
+  wr.resize ( nrad );
+  u.resize ( 4 * n );
+  radial_grid ( radial, nrad, r.data ( ), wr.data ( ) );
+
+  double *x = u.data ( );
+  double *y = x + n;
+  double *z = y + n;
+  double *w = z + n;
+  long k = 0;
+
+  for ( int i = 0; i < nrad; i++ )
+  {
+    const double *ux, *uy, *uz, *uw;
+    ld_table_by_order ( nang[i], &ux, &uy, &uz, &uw );
+
+    double wi = 4.0 * pi * wr[i];
+    for ( int j = 0; j < nang[i]; j++ )
+    {
+      x[k] = r[i] * ux[j];
+      y[k] = r[i] * uy[j];
+      z[k] = r[i] * uz[j];
+      w[k] = wi * uw[j];
+      k++;
+    }
+  }
+}
+
+}
+/******************************************************************************/
+
+long molecular_grid_size ( int natoms, const int *nrad, const int *nang )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    MOLECULAR_GRID_SIZE returns the number of points of a molecular grid.
+
+  Parameters:
+
+    Input, int NATOMS, the number of atoms.
+
+    Input, const int NRAD[NATOMS], NANG[NATOMS], the number of radial
+    shells, at most MOLECULAR_GRID_MAX_RADIAL, and the Lebedev order of
+    every atom.
+
+    Output, long MOLECULAR_GRID_SIZE, the number of points, or
+    MOLECULAR_GRID_EINVAL if an order is not available.
+*/
+{
+  const double *x, *y, *z, *w;
+  long total = 0;
+
+  if ( natoms < 1 || nrad == nullptr || nang == nullptr )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+  for ( int a = 0; a < natoms; a++ )
+  {
+    if ( nrad[a] < 1 || MOLECULAR_GRID_MAX_RADIAL < nrad[a] ||
+         ld_table_by_order ( nang[a], &x, &y, &z, &w ) == 0 )
+    {
+      return MOLECULAR_GRID_EINVAL;
+    }
+    total = total + ( long ) nrad[a] * nang[a];
+  }
+  return total;
+}
+/******************************************************************************/
+
+long molecular_grid ( int natoms, const double *coords, const double *rm,
+  const int *nrad, const int *nang, int radial, int partition, long capacity,
+  double *x, double *y, double *z, double *w )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    MOLECULAR_GRID generates a molecular integration grid.
+
+  Discussion:
+
+    Points are stored atom after atom, shell after shell (from the
+    nucleus outwards), with the Lebedev points of each shell in the order
+    of LD_BY_ORDER.  Weights include the r^2 volume element, so that
+      sum ( w[i] * f ( x[i], y[i], z[i] ) )
+    approximates the integral of f over all space.
+
+  Parameters:
+
+    Input, int NATOMS, the number of atoms.
+
+    Input, const double COORDS[NATOMS*3], the nuclear positions as a
+    column-major NATOMS x 3 matrix: all x, then all y, then all z.
+
+    Input, const double RM[NATOMS], the radial scaling of every atom
+    (e.g. half the Bragg-Slater radius), or NULL for 1.
+
+    Input, const int NRAD[NATOMS], NANG[NATOMS], the number of radial
+    shells and the Lebedev order of every atom.
+
+    Input, int RADIAL, MOLECULAR_GRID_PEREZ_JORDA or
+    MOLECULAR_GRID_GAUSS_CHEBYSHEV2ND.
+
+    Input, int PARTITION, MOLECULAR_GRID_NO_PARTITION (plain sum of atomic
+    grids) or MOLECULAR_GRID_BECKE.
+
+    Input, long CAPACITY, the length of X, Y, Z and W.
+
+    Output, double X[CAPACITY], Y[CAPACITY], Z[CAPACITY], W[CAPACITY],
+    the points and weights; only the first MOLECULAR_GRID_SIZE are set.
+
+    Output, long MOLECULAR_GRID, the number of points, or a negative
+    error: MOLECULAR_GRID_EINVAL for invalid arguments,
+    MOLECULAR_GRID_ENOSPC if CAPACITY is too small and
+    MOLECULAR_GRID_ENOMEM if an atomic grid could not be allocated.
+*/
+{
+  LD_INSTRUMENT_SCOPE ( LD_SITE_MOLECULAR_GRID );
+  long total = molecular_grid_size ( natoms, nrad, nang );
+
+  if ( total < 0 )
+  {
+    return total;
+  }
+  if ( coords == nullptr ||
+       ( radial != MOLECULAR_GRID_PEREZ_JORDA &&
+         radial != MOLECULAR_GRID_GAUSS_CHEBYSHEV2ND ) ||
+       ( partition != MOLECULAR_GRID_NO_PARTITION &&
+         partition != MOLECULAR_GRID_BECKE ) )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+  if ( capacity < total )
+  {
+    return MOLECULAR_GRID_ENOSPC;
+  }
+
+  Nuclei nuclei;
+  if ( nuclei_setup ( nuclei, natoms, coords, partition ) < 0 )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+
+  std::vector<long> offset ( natoms + 1, 0 );
+  for ( int a = 0; a < natoms; a++ )
+  {
+    offset[a+1] = offset[a] + ( long ) nrad[a] * nang[a];
+  }
+
+  int status = 0;
+
+# pragma omp parallel
+  {
+    std::vector<double> dist ( natoms );
+
+# pragma omp for schedule(dynamic)
+    for ( int a = 0; a < natoms; a++ )
+    {
+      const double *ux, *uy, *uz, *uw;
+      long n = atomic_grid ( nang[a], radial, nrad[a], &ux, &uy, &uz, &uw );
+
+      if ( n < 0 )
+      {
+# pragma omp atomic write
+        status = ( int ) n;
+        continue;
+      }
+
+      long k = offset[a];
+      place_atom ( nuclei, a, rm ? rm[a] : 1.0, n, ux, uy, uz, uw,
+        dist.data ( ), x + k, y + k, z + k, w + k );
+    }
+  }
+
+  if ( status < 0 )
+  {
+    return status;
+  }
+  return total;
+}
+/******************************************************************************/
+
+int pruned_orders ( int radial, int nrad, int nregions, const double *bounds,
+  const int *precision, int *nang )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    PRUNED_ORDERS picks the Lebedev order of every shell of a radial grid.
+
+  Discussion:
+
+    The radial range is cut by BOUNDS into NREGIONS regions: shell i, at
+    radius r[i] of RADIAL_GRID ( RADIAL, NRAD ), is in region k if
+    BOUNDS[k-1] <= r[i] < BOUNDS[k], and gets the smallest Lebedev rule of
+    precision PRECISION[k] (LEBEDEV_BY_PRECISION).  The radii are those of
+    the grid at the origin, so BOUNDS are in units of the radial scaling RM
+    of MOLECULAR_GRID.
+
+  Parameters:
+
+    Input, int RADIAL, the radial scheme.
+
+    Input, int NRAD, the number of shells, at most
+    MOLECULAR_GRID_MAX_RADIAL.
+
+    Input, int NREGIONS, the number of regions, at least 1.
+
+    Input, const double BOUNDS[NREGIONS-1], the increasing radii between
+    the regions.
+
+    Input, const int PRECISION[NREGIONS], the precision of every region,
+    the degree of the spherical harmonics integrated exactly.
+
+    Output, int NANG[NRAD], the Lebedev order of every shell.
+
+    Output, int PRUNED_ORDERS, 0, or MOLECULAR_GRID_EINVAL for invalid
+    arguments or a precision beyond every rule.
+*/
+{
+  if ( nrad < 1 || MOLECULAR_GRID_MAX_RADIAL < nrad || nregions < 1 ||
+       ( 1 < nregions && bounds == nullptr ) || precision == nullptr ||
+       nang == nullptr )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+  for ( int k = 1; k < nregions - 1; k++ )
+  {
+    if ( bounds[k] <= bounds[k-1] )
+    {
+      return MOLECULAR_GRID_EINVAL;
+    }
+  }
+
+  std::vector<int> orders ( nregions );
+  for ( int k = 0; k < nregions; k++ )
+  {
+    if ( lebedev_by_precision ( precision[k], &orders[k] ) != LEBEDEV_SUCCESS )
+    {
+      return MOLECULAR_GRID_EINVAL;
+    }
+  }
+
+  std::vector<double> r ( nrad );
+  std::vector<double> w ( nrad );
+  if ( radial_grid ( radial, nrad, r.data ( ), w.data ( ) ) < 0 )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+
+  for ( int i = 0, k = 0; i < nrad; i++ )
+  {
+    while ( k < nregions - 1 && bounds[k] <= r[i] )
+    {
+      k++;
+    }
+    nang[i] = orders[k];
+  }
+  return 0;
+}
+/******************************************************************************/
+
+long pruned_grid_size ( int natoms, const int *nrad, const int *nang )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    PRUNED_GRID_SIZE returns the number of points of a pruned molecular grid.
+
+  Parameters:
+
+    Input, int NATOMS, the number of atoms.
+
+    Input, const int NRAD[NATOMS], the number of radial shells of every
+    atom, at most MOLECULAR_GRID_MAX_RADIAL.
+
+    Input, const int NANG[], the Lebedev order of every shell, atom after
+    atom from the nucleus outwards: NRAD[0] + ... + NRAD[NATOMS-1] orders.
+
+    Output, long PRUNED_GRID_SIZE, the number of points, or
+    MOLECULAR_GRID_EINVAL if an order is not available.
+*/
+{
+  const double *x, *y, *z, *w;
+  long total = 0;
+  long shell = 0;
+
+  if ( natoms < 1 || nrad == nullptr || nang == nullptr )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+  for ( int a = 0; a < natoms; a++ )
+  {
+    if ( nrad[a] < 1 || MOLECULAR_GRID_MAX_RADIAL < nrad[a] )
+    {
+      return MOLECULAR_GRID_EINVAL;
+    }
+    for ( int i = 0; i < nrad[a]; i++, shell++ )
+    {
+      if ( ld_table_by_order ( nang[shell], &x, &y, &z, &w ) == 0 )
+      {
+        return MOLECULAR_GRID_EINVAL;
+      }
+      total = total + nang[shell];
+    }
+  }
+  return total;
+}
+/******************************************************************************/
+
+long pruned_molecular_grid ( int natoms, const double *coords,
+  const double *rm, const int *nrad, const int *nang, int radial,
+  int partition, long capacity, double *x, double *y, double *z, double *w )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    PRUNED_MOLECULAR_GRID generates a molecular grid with a Lebedev order
+    per radial shell.
+
+  Discussion:
+
+    Same as MOLECULAR_GRID, with one Lebedev order per shell of every atom
+    in NANG, as returned by PRUNED_ORDERS: shell i of atom a has order
+    NANG[NRAD[0] + ... + NRAD[a-1] + i].  Points are stored in the same
+    order, atom after atom and shell after shell.
+
+  Parameters:
+
+    Input, int NATOMS, const double COORDS[NATOMS*3], const double
+    RM[NATOMS], const int NRAD[NATOMS], as MOLECULAR_GRID.
+
+    Input, const int NANG[], the Lebedev order of every shell of every
+    atom, NRAD[0] + ... + NRAD[NATOMS-1] orders.
+
+    Input, int RADIAL, int PARTITION, long CAPACITY, as MOLECULAR_GRID.
+
+    Output, double X[CAPACITY], Y[CAPACITY], Z[CAPACITY], W[CAPACITY],
+    the points and weights; only the first PRUNED_GRID_SIZE are set.
+
+    Output, long PRUNED_MOLECULAR_GRID, the number of points, or a negative
+    error as MOLECULAR_GRID.
+*/
+{
+  LD_INSTRUMENT_SCOPE ( LD_SITE_PRUNED_MOLECULAR_GRID );
+  long total = pruned_grid_size ( natoms, nrad, nang );
+
+  if ( total < 0 )
+  {
+    return total;
+  }
+  if ( coords == nullptr ||
+       ( radial != MOLECULAR_GRID_PEREZ_JORDA &&
+         radial != MOLECULAR_GRID_GAUSS_CHEBYSHEV2ND ) ||
+       ( partition != MOLECULAR_GRID_NO_PARTITION &&
+         partition != MOLECULAR_GRID_BECKE ) )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+  if ( capacity < total )
+  {
+    return MOLECULAR_GRID_ENOSPC;
+  }
+
+  Nuclei nuclei;
+  if ( nuclei_setup ( nuclei, natoms, coords, partition ) < 0 )
+  {
+    return MOLECULAR_GRID_EINVAL;
+  }
+
+  std::vector<long> offset ( natoms + 1, 0 );
+  std::vector<long> shell ( natoms + 1, 0 );
+  for ( int a = 0; a < natoms; a++ )
+  {
+    shell[a+1] = shell[a] + nrad[a];
+    offset[a+1] = offset[a];
+    for ( long i = shell[a]; i < shell[a+1]; i++ )
+    {
+      offset[a+1] = offset[a+1] + nang[i];
+    }
+  }
+
+  int status = 0;
+
+# pragma omp parallel
+  {
+    std::vector<double> dist ( natoms );
+    std::vector<double> r, wr, u;
+
+# pragma omp for schedule(dynamic)
+    for ( int a = 0; a < natoms; a++ )
+    {
+      try
+      {
+        pruned_atom ( radial, nrad[a], nang + shell[a], r, wr, u );
+      }
+      catch ( const std::bad_alloc & )
+      {
+# pragma omp atomic write
+        status = MOLECULAR_GRID_ENOMEM;
+        continue;
+      }
+
+      long n = offset[a+1] - offset[a];
+      long k = offset[a];
+      const double *ux = u.data ( );
+      place_atom ( nuclei, a, rm ? rm[a] : 1.0, n, ux, ux + n, ux + 2 * n,
+        ux + 3 * n, dist.data ( ), x + k, y + k, z + k, w + k );
+    }
+  }
+
+  if ( status < 0 )
+  {
+    return status;
+  }
+  return total;
+}
@@ -0,0 +1,40 @@
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/* Radial schemes, mapped to [0,oo) with r = rm (1+x)/(1-x) */
+# define MOLECULAR_GRID_PEREZ_JORDA         1
+# define MOLECULAR_GRID_GAUSS_CHEBYSHEV2ND  2
+
+/* Atomic partition schemes */
+# define MOLECULAR_GRID_NO_PARTITION        0
+# define MOLECULAR_GRID_BECKE               1
+
+/* Errors, returned as negative point counts */
+# define MOLECULAR_GRID_EINVAL             -1
+# define MOLECULAR_GRID_ENOSPC             -2
+# define MOLECULAR_GRID_ENOMEM             -3
+
+/* Largest number of radial shells of a cached atomic grid */
+# define MOLECULAR_GRID_MAX_RADIAL         512
+
+long atomic_grid ( int nang, int radial, int nrad, const double **x,
+                  const double **y, const double **z, const double **w );
+long molecular_grid_size ( int natoms, const int *nrad, const int *nang );
+long molecular_grid ( int natoms, const double *coords, const double *rm,
+                      const int *nrad, const int *nang, int radial,
+                      int partition, long capacity,
+                      double *x, double *y, double *z, double *w );
+int pruned_orders ( int radial, int nrad, int nregions, const double *bounds,
+                    const int *precision, int *nang );
+long pruned_grid_size ( int natoms, const int *nrad, const int *nang );
+long pruned_molecular_grid ( int natoms, const double *coords,
+                             const double *rm, const int *nrad,
+                             const int *nang, int radial, int partition,
+                             long capacity, double *x, double *y, double *z,
+                             double *w );
+int radial_grid ( int radial, int n, double *r, double *w );
+
+# ifdef __cplusplus
+}
+# endif
@@ -0,0 +1,170 @@
+# include <cmath>
+
+# ifdef _OPENMP
+# include <omp.h>
+# endif
+
+# include "reductions.h"
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    Compensated sums, dot products, norms and grid integrals, in parallel
+    and reproducible to the last bit whatever the number of threads.
+
+  Discussion:
+
+    The input is cut into blocks of LD_REDUCE_BLOCK elements, fixed by N
+    alone.  Every block is summed over LANES interleaved Kahan accumulators
+    (element i goes to lane i mod LANES, which the compiler maps onto SIMD
+    registers), and the lanes are added pairwise.  The block sums are then
+    added in block order with one more Kahan sum.  Threads only decide who
+    sums which block, never how, so the result does not depend on their
+    number or on the scheduling.
+
+    Blocks are handed out GROUP at a time into a buffer on the stack: no
+    allocation, and one parallel region per GROUP * LD_REDUCE_BLOCK
+    elements.
+
+    Products are rounded once before being summed.  This file must not be
+    compiled with -ffast-math, which would optimise the compensations away.
+
+  Reference:
+
+    William Kahan,
+    Further remarks on reducing truncation errors,
+    Communications of the ACM,
+    Volume 8, Number 1, 1965, page 40.
+*/
+namespace
+{
+
+const int LANES = 8;
+const int GROUP = 256;
+
+struct Kahan
+{
+  double sum = 0.0, c = 0.0;
+
+  void add ( double v )
+  {
+    double y = v - c;
+    double t = sum + y;
+    c = ( t - sum ) - y;
+    sum = t;
+  }
+};
+
+template <bool PRODUCT>
+double block_sum ( long n, const double *x, const double *y )
+{
+  double s[LANES] = { 0.0 };
+  double c[LANES] = { 0.0 };
+  long i = 0;
+
+  for ( ; i + LANES <= n; i += LANES )
+  {
+    for ( int k = 0; k < LANES; k++ )
+    {
+      double v = PRODUCT ? x[i+k] * y[i+k] : x[i+k];
+      double u = v - c[k];
+      double t = s[k] + u;
+      c[k] = ( t - s[k] ) - u;
+      s[k] = t;
+    }
+  }
+  for ( int k = 0; i + k < n; k++ )
+  {
+    double v = PRODUCT ? x[i+k] * y[i+k] : x[i+k];
+    double u = v - c[k];
+    double t = s[k] + u;
+    c[k] = ( t - s[k] ) - u;
+    s[k] = t;
+  }
+
+  for ( int k = 0; k < LANES; k++ )
+  {
+    s[k] = s[k] - c[k];
+  }
+  for ( int width = LANES / 2; 0 < width; width = width / 2 )
+  {
+    for ( int k = 0; k < width; k++ )
+    {
+      s[k] = s[k] + s[k+width];
+    }
+  }
+  return s[0];
+}
+
+template <bool PRODUCT>
+double reduce ( long n, const double *x, const double *y, int nthreads )
+{
+  if ( n <= 0 )
+  {
+    return 0.0;
+  }
+  if ( n <= LD_REDUCE_BLOCK )
+  {
+    return block_sum<PRODUCT> ( n, x, y );
+  }
+
+# ifdef _OPENMP
+  int threads = 0 < nthreads ? nthreads : omp_get_max_threads ( );
+# else
+  ( void ) nthreads;
+# endif
+  long nblocks = ( n + LD_REDUCE_BLOCK - 1 ) / LD_REDUCE_BLOCK;
+  double partial[GROUP];
+  Kahan total;
+
+  for ( long first = 0; first < nblocks; first = first + GROUP )
+  {
+    int count = ( int ) ( nblocks - first < GROUP ? nblocks - first : GROUP );
+
+# pragma omp parallel for schedule(static) num_threads(threads) if(1 < count)
+    for ( int b = 0; b < count; b++ )
+    {
+      long start = ( first + b ) * LD_REDUCE_BLOCK;
+      long len = n - start < LD_REDUCE_BLOCK ? n - start : LD_REDUCE_BLOCK;
+      partial[b] = block_sum<PRODUCT> ( len, x + start, y ? y + start : y );
+    }
+
+    for ( int b = 0; b < count; b++ )
+    {
+      total.add ( partial[b] );
+    }
+  }
+  return total.sum;
+}
+
+}
+
+/******************************************************************************/
+
+double ld_sum ( long n, const double *x, int nthreads )
+{
+  return reduce<false> ( n, x, nullptr, nthreads );
+}
+
+double ld_dot ( long n, const double *x, const double *y, int nthreads )
+{
+  return reduce<true> ( n, x, y, nthreads );
+}
+
+/*
+  Not scaled: overflows for elements beyond about 1e154
+*/
+double ld_norm ( long n, const double *x, int nthreads )
+{
+  return std::sqrt ( reduce<true> ( n, x, x, nthreads ) );
+}
+
+double ld_integrate ( long n, const double *w, const double *f, int nthreads )
+{
+  if ( f == nullptr )
+  {
+    return reduce<false> ( n, w, nullptr, nthreads );
+  }
+  return reduce<true> ( n, w, f, nthreads );
+}
@@ -0,0 +1,22 @@
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/*
+  Reductions over vectors and grids with results that do not depend on the
+  number of threads: the same input always gives the same bits, see
+  reductions.cpp.  NTHREADS 0 uses the OpenMP default (OMP_NUM_THREADS).
+*/
+
+/* Elements per block, the unit of work of a thread */
+# define LD_REDUCE_BLOCK 4096
+
+double ld_sum ( long n, const double *x, int nthreads );
+double ld_dot ( long n, const double *x, const double *y, int nthreads );
+double ld_norm ( long n, const double *x, int nthreads );
+/* Quadrature sum w . f over a grid of N points, sum(w) if F is NULL */
+double ld_integrate ( long n, const double *w, const double *f, int nthreads );
+
+# ifdef __cplusplus
+}
+# endif
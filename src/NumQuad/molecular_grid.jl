@@ -0,0 +1,154 @@
+
+# Molecular integration grid generated in a single native call
+# (lebedev/molecular-grid.cpp, built into LIBLEBEDEV). Every atom gets a
+# radial grid, mapped to [0,∞) with r = rm (1+x)/(1-x), times a Lebedev
+# grid, and the points are weighted by Becke's fuzzy cell partition.
+# Atoms are processed in parallel (OpenMP).
+#
+#   xyz        Natoms × 3 nuclear positions, as returned by read_xyz_file
+#   nrad, nang number of radial shells and Lebedev order, for all atoms
+#              or per atom
+#   rm         radial scaling per atom (e.g. half the Bragg radius)
+#
+# Returns the Npoints × 3 matrix [x y z] and the weights, which include the
+# r² volume element so that sum(w .* f.(x,y,z)) ≈ ∫ f(r) d³r (or, compensated
+# and multithreaded, grid_integrate(w, f.(x,y,z))).
+
+const RADIAL_SCHEMES    = Dict(:perez_jorda        => 1,
+                               :gauss_chebyshev2nd => 2)
+const PARTITION_SCHEMES = Dict(:none  => 0,
+                               :becke => 1)
+
+# Grid of an atom at the origin (rm = 1, no partition) from the process-wide
+# cache of lebedev/grid-cache.cpp: built once per (nang, radial, nrad) and
+# then shared by all threads, which never wait for each other. The Npoints × 3
+# points and the weights alias the cached table: do not modify them.
+function atomic_grid(nang::Integer, nrad::Integer; radial = :perez_jorda)
+
+   x = Ref{Ptr{Float64}}(C_NULL)
+   y = Ref{Ptr{Float64}}(C_NULL)
+   z = Ref{Ptr{Float64}}(C_NULL)
+   w = Ref{Ptr{Float64}}(C_NULL)
+   npts = ccall((:atomic_grid, LIBLEBEDEV), Clong,
+                (Cint, Cint, Cint, Ref{Ptr{Float64}}, Ref{Ptr{Float64}},
+                 Ref{Ptr{Float64}}, Ref{Ptr{Float64}}),
+                nang, RADIAL_SCHEMES[radial], nrad, x, y, z, w)
+   npts < 0 && error("Could not build the atomic grid (error $npts)")
+
+   # y and z follow x contiguously
+   unsafe_wrap(Array, x[], (npts, 3)), unsafe_wrap(Array, w[], npts)
+end
+
+_per_atom(n::Integer, natoms) = fill(Cint(n), natoms)
+function _per_atom(n::AbstractVector, natoms)
+   length(n) == natoms || error("Need one value per atom")
+   Vector{Cint}(n)
+end
+
+function molecular_grid(xyz::Matrix{Float64}, nrad, nang;
+                        rm = ones(size(xyz, 1)),
+                        radial = :perez_jorda, partition = :becke)
+
+   size(xyz, 2) == 3 || error("Must be Natoms × 3 matrix")
+   natoms = size(xyz, 1)
+   nrad = _per_atom(nrad, natoms)
+   nang = _per_atom(nang, natoms)
+   rm   = Vector{Float64}(rm)
+   length(rm) == natoms || error("Need one radial scaling per atom")
+
+   npts = ccall((:molecular_grid_size, LIBLEBEDEV), Clong,
+                (Cint, Ptr{Cint}, Ptr{Cint}),
+                natoms, nrad, nang)
+   npts < 0 && error("Invalid number of radial shells or Lebedev order")
+
+   points  = Matrix{Float64}(undef, npts, 3)
+   weights = Vector{Float64}(undef, npts)
+
+   # x, y and z are the columns of points
+   status = GC.@preserve points begin
+      x = pointer(points)
+      ccall((:molecular_grid, LIBLEBEDEV), Clong,
+            (Cint, Ptr{Float64}, Ptr{Float64}, Ptr{Cint}, Ptr{Cint}, Cint, Cint,
+             Clong, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}),
+            natoms, xyz, rm, nrad, nang,
+            RADIAL_SCHEMES[radial], PARTITION_SCHEMES[partition],
+            npts, x, x + sizeof(Float64)npts, x + 2sizeof(Float64)npts, weights)
+   end
+   status == npts || error("Could not build the molecular grid (error $status)")
+
+   points, weights
+end
+
+# Pruned grids (lebedev/molecular-grid.cpp): a Lebedev order per radial shell
+# rather than per atom, low near the nucleus and far out, high in the valence
+# region, for far fewer points at the same accuracy.
+#
+# pruned_orders cuts the radial range at the increasing `bounds`, radii of
+# the grid at the origin (so in units of rm), into regions; the shells of
+# region k get the smallest Lebedev rule of precision precisions[k]
+# (precision_table in lebedev-laikov.c).
+function pruned_orders(nrad::Integer, bounds, precisions; radial = :perez_jorda)
+
+   length(bounds) == length(precisions) - 1 || error("Need one precision per region")
+   nang = Vector{Cint}(undef, nrad)
+   status = ccall((:pruned_orders, LIBLEBEDEV), Cint,
+                  (Cint, Cint, Cint, Ptr{Float64}, Ptr{Cint}, Ptr{Cint}),
+                  RADIAL_SCHEMES[radial], nrad, length(precisions),
+                  Vector{Float64}(bounds), Vector{Cint}(precisions), nang)
+   status == 0 || error("Invalid regions, number of shells or precision")
+   Vector{Int}(nang)
+end
+
+# SG-1 partition (P. M. W. Gill, B. G. Johnson, J. A. Pople, Chem. Phys.
+# Lett. 209, 506 (1993)) of hydrogen to argon: bounds αᵢ R in units of the
+# Bragg radius R, with the precisions of the orders 6, 38, 86, 194 and 86.
+# Returns the bounds for a radial scaling rm given in units of R.
+const SG1_BOUNDS     = ([0.2500, 0.5000, 1.0000, 4.5000],   # H, He
+                        [0.1667, 0.5000, 0.9000, 3.5000],   # Li - Ne
+                        [0.1000, 0.4000, 0.8000, 2.5000])   # Na - Ar
+const SG1_PRECISIONS = [3, 9, 15, 23, 15]
+
+function sg1_partition(Z::Integer; rm = 1.0)
+   1 ≤ Z ≤ 18 || error("SG-1 is only defined from H to Ar")
+   row = Z ≤ 2 ? 1 : Z ≤ 10 ? 2 : 3
+   SG1_BOUNDS[row] ./ rm, SG1_PRECISIONS
+end
+
+# Molecular grid like molecular_grid, with `nang` the Lebedev orders of every
+# shell: one vector of nrad orders per atom (e.g. from pruned_orders), or a
+# single one for all atoms
+function pruned_molecular_grid(xyz::Matrix{Float64}, nrad, nang::AbstractVector;
+                               rm = ones(size(xyz, 1)),
+                               radial = :perez_jorda, partition = :becke)
+
+   size(xyz, 2) == 3 || error("Must be Natoms × 3 matrix")
+   natoms = size(xyz, 1)
+   nrad = _per_atom(nrad, natoms)
+   nang = eltype(nang) <: Integer ? fill(nang, natoms) : nang
+   length(nang) == natoms && all(length(nang[a]) == nrad[a] for a in 1:natoms) ||
+      error("Need one Lebedev order per radial shell of every atom")
+   shells = Vector{Cint}(reduce(vcat, nang))
+   rm = Vector{Float64}(rm)
+   length(rm) == natoms || error("Need one radial scaling per atom")
+
+   npts = ccall((:pruned_grid_size, LIBLEBEDEV), Clong,
+                (Cint, Ptr{Cint}, Ptr{Cint}),
+                natoms, nrad, shells)
+   npts < 0 && error("Invalid number of radial shells or Lebedev order")
+
+   points  = Matrix{Float64}(undef, npts, 3)
+   weights = Vector{Float64}(undef, npts)
+
+   status = GC.@preserve points begin
+      x = pointer(points)
+      ccall((:pruned_molecular_grid, LIBLEBEDEV), Clong,
+            (Cint, Ptr{Float64}, Ptr{Float64}, Ptr{Cint}, Ptr{Cint}, Cint, Cint,
+             Clong, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}, Ptr{Float64}),
+            natoms, xyz, rm, nrad, shells,
+            RADIAL_SCHEMES[radial], PARTITION_SCHEMES[partition],
+            npts, x, x + sizeof(Float64)npts, x + 2sizeof(Float64)npts, weights)
+   end
+   status == npts || error("Could not build the pruned grid (error $status)")
+
+   points, weights
+end
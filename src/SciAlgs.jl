@@ -3,6 +3,7 @@ module SciAlgs
 include("car2int.jl")
 include("geometry.jl")
 include("io.jl")
+include("binary_cache.jl")
 include("validate_dni.jl")
 include("validate_isbn.jl")
 
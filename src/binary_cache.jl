@@ -0,0 +1,146 @@
+# Binary cache of arrays (grids, integral tensors) for warm starts: written
+# once, then memory-mapped read-only, so that later runs skip the computation
+# and the processes of a node share the same pages of the page cache.
+#
+# Layout, in the byte order of the writer (checked by the reader):
+#   header  64 bytes:  magic "SCIALGS\0" | version::UInt32 | 0x01020304::UInt32
+#                      | nsections::UInt32 | reserved
+#   table   96 bytes per section:  name (NUL padded, 32 bytes)
+#                      | eltype::UInt32 | ndims::UInt32 | dims::NTuple{4,Int64}
+#                      | offset::Int64 | nbytes::Int64 | crc32c::UInt32 | reserved
+#   data    every section at its offset, a multiple of CACHE_ALIGNMENT
+# eltype is the index in CACHE_ELTYPES and arrays are column-major, so that
+# any native code can map the same file.
+
+import Mmap
+import CRC32c: crc32c
+
+const CACHE_MAGIC     = b"SCIALGS\0"
+const CACHE_VERSION   = UInt32(1)
+const CACHE_ALIGNMENT = 64
+const CACHE_ELTYPES   = (Float64, Float32, Int64, Int32, UInt8, ComplexF64)
+const CACHE_HEADER    = 64
+const CACHE_ENTRY     = 96
+const CACHE_NAME      = 32
+
+struct CacheFormatError <: Exception
+   msg::String
+end
+Base.showerror(io::IO, e::CacheFormatError) = print(io, "CacheFormatError: ", e.msg)
+
+_cache_align(n) = cld(n, CACHE_ALIGNMENT) * CACHE_ALIGNMENT
+_cache_crc(A::Array) = GC.@preserve A crc32c(unsafe_wrap(Vector{UInt8}, Ptr{UInt8}(pointer(A)), sizeof(A)))
+
+"""
+    write_cache(filename, sections)
+
+Write the arrays of `sections`, pairs `name => array` with an element type
+in `CACHE_ELTYPES` and up to 4 dimensions, to the cache `filename`. The file
+is written aside and renamed, so that readers never see it half written.
+"""
+function write_cache(filename, sections)
+   sections = [String(name) => A for (name, A) in sections]
+   for (name, A) in sections
+      sizeof(name) < CACHE_NAME || throw(ArgumentError("section name too long: $name"))
+      A isa Array && eltype(A) in CACHE_ELTYPES && 1 ≤ ndims(A) ≤ 4 ||
+         throw(ArgumentError("section $name: $(typeof(A)) can not be cached"))
+   end
+
+   tmp = "$filename.$(getpid()).tmp"
+   open(tmp, "w") do io
+      write(io, CACHE_MAGIC, CACHE_VERSION, UInt32(0x01020304), UInt32(length(sections)))
+      write(io, zeros(UInt8, CACHE_HEADER - position(io)))
+
+      offset = _cache_align(CACHE_HEADER + CACHE_ENTRY*length(sections))
+      offsets = Int64[]
+      for (name, A) in sections
+         push!(offsets, offset)
+         write(io, codeunits(name), zeros(UInt8, CACHE_NAME - sizeof(name)))
+         write(io, UInt32(findfirst(==(eltype(A)), CACHE_ELTYPES)), UInt32(ndims(A)))
+         write(io, (Int64(k ≤ ndims(A) ? size(A, k) : 0) for k in 1:4)...)
+         write(io, Int64(offset), Int64(sizeof(A)), _cache_crc(A), UInt32(0))
+         offset = _cache_align(offset + sizeof(A))
+      end
+      for ((_, A), offset) in zip(sections, offsets)
+         write(io, zeros(UInt8, offset - position(io)))
+         write(io, A)
+      end
+   end
+   mv(tmp, filename, force=true)
+end
+
+"""
+    map_cache(filename; verify=false)
+
+Sections of the cache `filename` as a `Dict` of read-only memory-mapped
+arrays: pages are only read when used, and shared with every other process
+mapping the same file. With `verify=true` the checksums are compared, which
+reads the whole file. Throws `CacheFormatError` for a file that is not a
+cache of this version.
+"""
+function map_cache(filename; verify=false)
+   open(filename, "r") do io
+      len = filesize(io)
+      len ≥ CACHE_HEADER && read(io, length(CACHE_MAGIC)) == CACHE_MAGIC ||
+         throw(CacheFormatError("$filename is not a cache file"))
+      version = read(io, UInt32)
+      version == CACHE_VERSION ||
+         throw(CacheFormatError("$filename: version $version, expected $CACHE_VERSION"))
+      read(io, UInt32) == 0x01020304 ||
+         throw(CacheFormatError("$filename: written with another byte order"))
+      nsections = Int(read(io, UInt32))
+      CACHE_HEADER + CACHE_ENTRY*nsections ≤ len ||
+         throw(CacheFormatError("$filename: truncated section table"))
+
+      sections = Dict{String,Array}()
+      for s in 1:nsections
+         seek(io, CACHE_HEADER + CACHE_ENTRY*(s-1))
+         name = String(rstrip(String(read(io, CACHE_NAME)), '\0'))
+         code, nd = Int(read(io, UInt32)), Int(read(io, UInt32))
+         dims = [read(io, Int64) for _ in 1:4]
+         offset, nbytes = read(io, Int64), read(io, Int64)
+         crc = read(io, UInt32)
+
+         1 ≤ code ≤ length(CACHE_ELTYPES) && 1 ≤ nd ≤ 4 ||
+            throw(CacheFormatError("$filename: bad section $name"))
+         T = CACHE_ELTYPES[code]
+         dims = Tuple(dims[1:nd])
+         nbytes == sizeof(T)*prod(dims) && offset % CACHE_ALIGNMENT == 0 &&
+            0 ≤ offset && offset + nbytes ≤ len ||
+            throw(CacheFormatError("$filename: bad section $name"))
+
+         A = nbytes == 0 ? Array{T}(undef, dims) :
+                           Mmap.mmap(io, Array{T,nd}, dims, offset, grow=false)
+         verify && _cache_crc(A) != crc &&
+            throw(CacheFormatError("$filename: checksum of section $name"))
+         sections[name] = A
+      end
+      sections
+   end
+end
+
+"""
+    cached(compute, filename; key=nothing, verify=false)
+
+Warm start: the sections of the cache `filename`, memory-mapped, if it
+exists and was written for the same `key` (an array that can be cached,
+e.g. the geometry); otherwise the `name => array` pairs returned by
+`compute()` are written to `filename` first. A stale or foreign file is overwritten.
+"""
+function cached(compute, filename; key=nothing, verify=false)
+   if isfile(filename)
+      try
+         sections = map_cache(filename, verify=verify)
+         if key === nothing || get(sections, "key", nothing) == key
+            return sections
+         end
+      catch e
+         e isa CacheFormatError || rethrow()
+         @warn "Recomputing $filename" exception=e
+      end
+   end
+   sections = Pair{String,Any}[name => A for (name, A) in compute()]
+   key === nothing || push!(sections, "key" => key)
+   write_cache(filename, sections)
+   map_cache(filename)
+end
@@ -1,4 +1,16 @@
+#include <stdint.h>
 
 double mean(double a, double b) {
   return (a+b) / 2;
 }
+
+/* Batched mean(): out[i] = (a[i]+b[i])/2 for 0 <= i < n, one call for the
+   whole arrays. Same ABI as the other batched interop kernels (Fortran
+   mypow_batch, Rust double_input_batch): inputs, outputs, int64 length. */
+void mean_batch(const double *restrict a, const double *restrict b,
+                double *restrict out, int64_t n) {
+#pragma omp simd
+  for (int64_t i = 0; i < n; i++) {
+    out[i] = (a[i]+b[i]) / 2;
+  }
+}
@@ -6,7 +6,8 @@
 const CLIB    = joinpath(@__DIR__, "libmean.so")
 const CSOURCE = joinpath(@__DIR__, "calc_mean.c")
 
-run(`gcc -Wall -shared -O2 -fPIC -o $CLIB $CSOURCE`)
+# -fopenmp-simd: the SIMD loop of mean_batch
+run(`gcc -Wall -shared -O3 -fopenmp-simd -fPIC -o $CLIB $CSOURCE`)
 
 @static if VERSION >= v"1.5.0"
 
@@ -14,6 +15,17 @@ run(`gcc -Wall -shared -O2 -fPIC -o $CLIB $CSOURCE`)
 
    @time g(4.0,6.0)
    @assert g(4.0,6.0) ≈ 5
+
+   # Whole arrays in one call: the ccall overhead is paid once, not per element
+   function g!(out::Vector{Float64}, x::Vector{Float64}, y::Vector{Float64})
+      length(x) == length(y) == length(out) || throw(DimensionMismatch())
+      @ccall CLIB.mean_batch(x::Ptr{Cdouble}, y::Ptr{Cdouble}, out::Ptr{Cdouble},
+                             length(out)::Int64)::Cvoid
+      out
+   end
+
+   x, y = rand(1000), rand(1000)
+   @assert g!(similar(x), x, y) ≈ g.(x, y)
 else
 
    f(x::Float64,y::Float64) = ccall((:mean, CLIB),Float64,(Float64,Float64),x,y)
@@ -1,7 +1,8 @@
 
 # Taken from https://nbviewer.jupyter.org/github/mfherbst/course_julia_day/blob/master/07_Other_Language_Features.ipynb
 
-# C code string
+# C code string: a plain serial sum, see ld_sum in NumQuad/lebedev/reductions.cpp
+# for a compensated, multithreaded and reproducible one
 code = """
 double sum_array(double* array, int n) {
     double accu = 0.0;
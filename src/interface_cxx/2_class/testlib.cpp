@@ -10,13 +10,26 @@ class Foo
     Foo* thisptr() { return this; }
     Foo& thisref() { return *this; }
     Foo thiscopy() { return *this; }
-    const int* valueptr() { return &m_value; }
+    const int* valueptr() const { return &m_value; }
   private:
     int m_value;
 };
 
 struct MyStruct { MyStruct() {} };
 
+// Plain-data counterpart of Foo, mirrored by an isbits Julia struct of the
+// same layout: a Vector{FooBits} is passed as the Julia-owned memory itself
+// (ArrayRef), with no boxing and no per-element copies
+struct FooBits
+{
+  int value;
+};
+
+namespace jlcxx
+{
+  template<> struct IsMirroredType<FooBits> : std::true_type { };
+}
+
 JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
 {
   mod.add_type<MyStruct>("MyStruct");
@@ -30,11 +43,32 @@ JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
   mod.method("sumfoos", [] (const std::vector<Foo>& vec)
   {
     int result = 0;
-    for (auto foo: vec)
+    for (const auto& foo: vec)
     {
       result += *foo.valueptr();
     }
     return result;
   });
+
+  mod.map_type<FooBits>("FooBits");
+  // Read and updated in place in Julia memory
+  mod.method("sumfoos", [] (jlcxx::ArrayRef<FooBits> foos)
+  {
+    const FooBits* data = foos.data();
+    int result = 0;
+    for (std::size_t i = 0; i < foos.size(); i++)
+    {
+      result += data[i].value;
+    }
+    return result;
+  });
+  mod.method("addfoos!", [] (jlcxx::ArrayRef<FooBits> foos, int i)
+  {
+    FooBits* data = foos.data();
+    for (std::size_t k = 0; k < foos.size(); k++)
+    {
+      data[k].value += i;
+    }
+  });
 }
 
@@ -1,6 +1,12 @@
 # Load the module and generate the functions
 module CppClass
   using CxxWrap
+
+  # Same layout as FooBits in testlib.cpp (map_type)
+  struct FooBits
+    value::Cint
+  end
+
   @wrapmodule(joinpath(@__DIR__, "build/lib/libtestlib"))
 
   function __init__()
@@ -8,6 +14,25 @@ module CppClass
   end
 end
 
+using CxxWrap: StdVector
+
 # Test
 f = CppClass.Foo(4)
 @assert CppClass.add(f, 4) == 8 # 4 + 4
+
+# Arrays of bits types are read and written in place
+foos = CppClass.FooBits.(Cint.(1:1000))
+@assert CppClass.sumfoos(foos) == sum(1:1000)
+CppClass.addfoos!(foos, 1)
+@assert foos[1] == CppClass.FooBits(2) && foos[end] == CppClass.FooBits(1001)
+
+# while a StdVector{Foo} holds boxed C++ objects
+@assert CppClass.sumfoos(StdVector([CppClass.Foo(i) for i in 1:10])) == sum(1:10)
+
+# No per-element allocation: the same for 10 and 10⁶ FooBits
+allocations(foos) = @allocated CppClass.sumfoos(foos)
+small = fill(CppClass.FooBits(1), 10)
+large = fill(CppClass.FooBits(1), 10^6)
+allocations(small)
+@assert CppClass.sumfoos(large) == 10^6
+@assert allocations(large) == allocations(small)
@@ -0,0 +1,124 @@
+// N-d view of Julia array memory that carries its dims and strides, so that
+// kernels index Julia arrays (column-major) in place: dense Arrays through
+// jlcxx::ArrayRef, and any strided array (e.g. a non-contiguous view) from
+// its pointer, size and strides, without copies.
+
+#ifndef STRIDED_VIEW_HPP
+#define STRIDED_VIEW_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+
+#include "jlcxx/jlcxx.hpp"
+
+template<typename T, std::size_t N>
+class StridedView
+{
+public:
+  // Strides in elements, as Julia's strides(A)
+  StridedView(T* data, const std::array<int64_t,N>& dims,
+              const std::array<int64_t,N>& strides)
+    : data_(data), dims_(dims), strides_(strides)
+  {
+  }
+
+  // Dense Julia Array: column-major strides 1, dims[0], dims[0]*dims[1], ...
+  explicit StridedView(jlcxx::ArrayRef<T,N> a) : data_(a.data())
+  {
+    int64_t stride = 1;
+    for (std::size_t k = 0; k < N; k++)
+    {
+      dims_[k] = int64_t(jl_array_dim(a.wrapped(), int(k)));
+      strides_[k] = stride;
+      stride *= dims_[k];
+    }
+  }
+
+  // 0-based indices
+  template<typename... I>
+  T& operator()(I... idx) const
+  {
+    static_assert(sizeof...(I) == N, "one index per dimension");
+    const int64_t i[] = {int64_t(idx)...};
+    int64_t offset = 0;
+    for (std::size_t k = 0; k < N; k++)
+    {
+      offset += i[k]*strides_[k];
+    }
+    return data_[offset];
+  }
+
+  // Same, checked against the dims
+  template<typename... I>
+  T& at(I... idx) const
+  {
+    const int64_t i[] = {int64_t(idx)...};
+    for (std::size_t k = 0; k < N; k++)
+    {
+      if (i[k] < 0 || i[k] >= dims_[k])
+      {
+        throw std::out_of_range("index out of bounds");
+      }
+    }
+    return (*this)(idx...);
+  }
+
+  T* data() const { return data_; }
+  int64_t dim(std::size_t k) const { return dims_[k]; }
+  int64_t stride(std::size_t k) const { return strides_[k]; }
+
+  int64_t size() const
+  {
+    int64_t n = 1;
+    for (auto d : dims_) n *= d;
+    return n;
+  }
+
+  // Column-major without gaps: can be traversed as one flat range
+  bool contiguous() const
+  {
+    int64_t stride = 1;
+    for (std::size_t k = 0; k < N; k++)
+    {
+      if (dims_[k] > 1 && strides_[k] != stride) return false;
+      stride *= dims_[k];
+    }
+    return true;
+  }
+
+private:
+  T* data_;
+  std::array<int64_t,N> dims_;
+  std::array<int64_t,N> strides_;
+};
+
+template<typename T>
+using MatrixView = StridedView<T,2>;
+
+// f(i, j) for every element of a matrix, by tile x tile blocks (column-major
+// inside and between blocks), so that kernels touching a row and a column
+// of the same block, like transposes, stay in cache
+template<typename T, typename F>
+void for_each_tiled(const MatrixView<T>& a, int64_t tile, F&& f)
+{
+  const int64_t m = a.dim(0), n = a.dim(1);
+  for (int64_t j0 = 0; j0 < n; j0 += tile)
+  {
+    const int64_t j1 = std::min(j0 + tile, n);
+    for (int64_t i0 = 0; i0 < m; i0 += tile)
+    {
+      const int64_t i1 = std::min(i0 + tile, m);
+      for (int64_t j = j0; j < j1; j++)
+      {
+        for (int64_t i = i0; i < i1; i++)
+        {
+          f(i, j);
+        }
+      }
+    }
+  }
+}
+
+#endif
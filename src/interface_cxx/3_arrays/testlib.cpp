@@ -1,28 +1,53 @@
 
+#include <algorithm>
+#include <cstdlib>
+#include <new>
 #include <valarray>
 
 #include "jlcxx/jlcxx.hpp"
 #include "jlcxx/stl.hpp"
 #include "jlcxx/const_array.hpp"
 
+#include "strided-view.hpp"
+
 // take Julia array as argument and return type
 void test_array_set(jlcxx::ArrayRef<double> a, const int64_t i, const double v)
 {
   a[i] = v;
 }
 
+// 0-based (i, j) of a Julia matrix of any shape, column-major
 void test_matrix_set(jlcxx::ArrayRef<double,2> a, const int64_t i, const int64_t j, const double v)
 {
-  // Assumes ? x 3 matrix
-  a[i*3+j] = v;
+  MatrixView<double>(a).at(i, j) = v;
+}
+
+// Same for any strided matrix (Julia views included), given as pointer,
+// size and strides
+void strided_matrix_set(double* p, const int64_t m, const int64_t n,
+                        const int64_t s1, const int64_t s2,
+                        const int64_t i, const int64_t j, const double v)
+{
+  MatrixView<double>(p, {m, n}, {s1, s2}).at(i, j) = v;
+}
+
+// B = Aᵀ between strided matrices, traversed by tiles
+void strided_transpose(double* pb, const int64_t sb1, const int64_t sb2,
+                       double* pa, const int64_t m, const int64_t n,
+                       const int64_t sa1, const int64_t sa2)
+{
+  const MatrixView<const double> a(pa, {m, n}, {sa1, sa2});
+  const MatrixView<double> b(pb, {n, m}, {sb1, sb2});
+  for_each_tiled(a, 32, [&](int64_t i, int64_t j) { b(j, i) = a(i, j); });
 }
 
 // Constant 1D array
 const double* const_vector()
 {
   // You need to declare static to prolong the life of d after exit,
-  // otherwise you would get memory garbage.
-  static double d[] = {1., 2., 3};
+  // otherwise you would get memory garbage. Being read-only, it is safe to
+  // share between calls and threads.
+  static const double d[] = {1., 2., 3};
   return &d[0];
 }
 
@@ -30,28 +55,54 @@ const double* const_vector()
 const double* const_matrix()
 {
   // You need to declare static to prolong the life of d after exit
-  static double d[2][3] = {{1., 2., 3}, {4., 5., 6.}};
+  static const double d[2][3] = {{1., 2., 3}, {4., 5., 6.}};
   return &d[0][0];
 }
 
+// Fresh Julia-owned array: the buffer is malloc'ed and handed over to the
+// Array (julia_owned), which frees it when it is garbage collected. Every
+// call gets its own result, so this is reentrant and thread-safe, unlike a
+// static buffer, and nothing on the stack can dangle.
+template<typename... Dims>
+jlcxx::ArrayRef<double, sizeof...(Dims)> owned_array(const Dims... dims)
+{
+  const std::size_t n = (std::size_t(1) * ... * std::size_t(dims));
+  double* data = static_cast<double*>(std::malloc(n*sizeof(double)));
+  if (data == nullptr) throw std::bad_alloc();
+  return jlcxx::ArrayRef<double, sizeof...(Dims)>(true, data, dims...);
+}
+
 // 1D array
-//double* mutable_vector()
-//{
-//  //double d[] = {1., 2., 3};
-//  double d[3];
-//  d[0] = 1.0;
-//  d[1] = 2.0;
-//  d[2] = 3.0;
-//  double* out = d;
-//  return out;
-//}
-
-// Multidimensional
-//double* mutable_matrix()
-//{
-//  double d[2][3] = {{1., 2., 3}, {4., 5., 6.}};
-//  return &d[0][0];
-//}
+jlcxx::ArrayRef<double> mutable_vector()
+{
+  auto d = owned_array(3);
+  d[0] = 1.0;
+  d[1] = 2.0;
+  d[2] = 3.0;
+  return d;
+}
+
+// Multidimensional, 3 x 2 column-major
+jlcxx::ArrayRef<double,2> mutable_matrix()
+{
+  auto d = owned_array(3, 2);
+  for (int k = 0; k < 6; k++)
+  {
+    d.data()[k] = k + 1.0;
+  }
+  return d;
+}
+
+// New array s*a, computed without touching any shared state
+jlcxx::ArrayRef<double> scaled(jlcxx::ArrayRef<double> a, const double s)
+{
+  auto b = owned_array(a.size());
+  for (std::size_t k = 0; k < a.size(); k++)
+  {
+    b.data()[k] = s*a.data()[k];
+  }
+  return b;
+}
 
 void eval_rho(double& rho) {
     rho = 4.0;
@@ -63,23 +114,24 @@ JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
   mod.method("eval_rho", &eval_rho );
   mod.method("test_array_set", &test_array_set);
   mod.method("test_matrix_set", &test_matrix_set);
+  mod.method("strided_matrix_set", &strided_matrix_set);
+  mod.method("strided_transpose", &strided_transpose);
   mod.method("return_array", []() {
-        // You need to declare static to prolong the life of a after exit
-        static double a[2][3] = {{1., 2., 3}, {4., 5., 6.}};
-        return jlcxx::make_julia_array(&a[0][0], 3, 2);
+        // Owned by Julia, see owned_array
+        return mutable_matrix();
       });
   mod.method("const_vector",   []() { return jlcxx::make_const_array(const_vector(), 3); });
   mod.method("const_matrix",   []() { return jlcxx::make_const_array(const_matrix(), 3, 2); });
-  //mod.method("mutable_vector", []() { return jlcxx::make_julia_array(const_vector(), 3); });
-  //mod.method("mutable_matrix", []() { return jlcxx::make_julia_array(const_matrix(), 3, 2); });
-
-  //mod.method("mutable_vector", []() { return jlcxx::make_julia_array(mutable_vector(), 3); });
-  //mod.method("mutable_matrix", []() { return jlcxx::make_julia_array(mutable_matrix(), 3, 2); });
+  mod.method("mutable_vector", &mutable_vector);
+  mod.method("mutable_matrix", &mutable_matrix);
+  mod.method("scaled", &scaled);
   mod.method("return_valarray", []() {
         double _a[] = {1., 2., 3, 4., 5., 6.};
-        // You need to declare static to prolong the life of a after exit
-        static std::valarray<double> a(_a, 6);
-        return jlcxx::make_julia_array(&a[0], 3,2);
+        const std::valarray<double> a(_a, 6);
+        // Computed locally, then moved into an owned array
+        auto out = owned_array(3, 2);
+        std::copy(std::begin(a), std::end(a), out.data());
+        return out;
       });
 
 }
@@ -6,6 +6,20 @@ module CppArrays
   function __init__()
     @initcxx
   end
+
+  # Any strided matrix, e.g. a non-contiguous view, passed in place as
+  # pointer, size and strides (StridedView in strided-view.hpp)
+  function matrix_set!(A::StridedMatrix{Float64}, i, j, v)
+    GC.@preserve A strided_matrix_set(pointer(A), size(A)..., strides(A)..., i, j, v)
+    A
+  end
+
+  function transpose!(B::StridedMatrix{Float64}, A::StridedMatrix{Float64})
+    size(B) == reverse(size(A)) || throw(DimensionMismatch("B must be $(reverse(size(A)))"))
+    GC.@preserve A B strided_transpose(pointer(B), strides(B)...,
+                                       pointer(A), size(A)..., strides(A)...)
+    B
+  end
 end
 using .CppArrays
 
@@ -14,7 +28,43 @@ ta = [1.0, 2.0]
 CppArrays.test_array_set(ta, 0, 3.0)
 @assert ta ≈ [3.0, 2.0]
 
+# Julia matrices of any shape, column-major, 0-based indices
+tm = zeros(4, 5)
+CppArrays.test_matrix_set(tm, 1, 3, 7.0)
+@assert tm[2, 4] == 7.0 && count(!iszero, tm) == 1
+
+# Non-contiguous views, in place
+big = zeros(9, 8)
+v = view(big, 2:2:8, 3:2:7)
+CppArrays.matrix_set!(v, 2, 1, 5.0)
+@assert big[6, 5] == 5.0 && count(!iszero, big) == 1
+
+A = reshape(collect(1.0:70.0), 7, 10)
+B = zeros(12, 9)
+CppArrays.transpose!(view(B, 2:11, 1:7), view(A, :, :))
+@assert B[2:11, 1:7] == permutedims(A)
+CppArrays.transpose!(view(B, 1:2:5, 1:2), view(A, 1:2, 4:2:8))
+@assert B[1:2:5, 1:2] == permutedims(A[1:2, 4:2:8])
+
 # Produce a 1D Julia array
+@assert CppArrays.const_vector() == [1.0, 2.0, 3.0]
+x = CppArrays.mutable_vector()
+@assert x == [1.0, 2.0, 3.0]
+x[1] = 10.0                                  # owned by Julia, so writable
+@assert CppArrays.mutable_vector() == [1.0, 2.0, 3.0]
 
 # Produce a nD Julia array
-#display(CppClass.const_matrix())
+@assert CppArrays.const_matrix() == reshape(1.0:6.0, 3, 2)
+@assert CppArrays.mutable_matrix() == reshape(1.0:6.0, 3, 2)
+@assert CppArrays.return_array() == CppArrays.return_valarray() == reshape(1.0:6.0, 3, 2)
+a, b = CppArrays.return_array(), CppArrays.return_array()
+@assert pointer(a) != pointer(b)             # fresh buffers, no shared static
+
+# Fresh results from many threads at once; the buffers are freed by the GC
+results = Vector{Vector{Float64}}(undef, 64)
+Threads.@threads for k in eachindex(results)
+  results[k] = CppArrays.scaled(collect(1.0:100.0), k)
+end
+@assert all(results[k] == k .* (1.0:100.0) for k in eachindex(results))
+results = nothing
+GC.gc()
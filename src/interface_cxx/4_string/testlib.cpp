@@ -1,18 +1,55 @@
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 #include "jlcxx/jlcxx.hpp"
 #include "jlcxx/stl.hpp"
 
-int read_string(std::string s) {
-  return s.length();
+#include "xyz-reader.hpp"
+
+// The bytes of a Julia String, passed in place as a Vector{UInt8} over its
+// memory (bytes() in testlib.jl): no std::string is built, so no copies
+std::string_view view(jlcxx::ArrayRef<std::uint8_t> s)
+{
+  return std::string_view(reinterpret_cast<const char*>(s.data()), s.size());
+}
+
+int read_string(jlcxx::ArrayRef<std::uint8_t> s) {
+  return view(s).length();
 }
-std::string echo_string(std::string s) {
-  return s;
+// The result is new, so it is the only copy
+std::string echo_string(jlcxx::ArrayRef<std::uint8_t> s) {
+  return std::string(view(s));
+}
+
+// Atoms in the XYZ frame at byte `offset` of s, -1 if there is none
+std::int64_t xyz_natoms(jlcxx::ArrayRef<std::uint8_t> s, std::int64_t offset)
+{
+  return xyz::Reader(view(s), offset).natoms();
+}
+
+// The XYZ frame at byte `offset` of s into the Julia arrays Z and xyz
+// (3 x natoms); returns where the next frame starts. Errors are thrown,
+// i.e. raised in Julia.
+std::int64_t xyz_read(jlcxx::ArrayRef<std::uint8_t> s, std::int64_t offset,
+                      jlcxx::ArrayRef<std::int32_t> Z, jlcxx::ArrayRef<double,2> xyz)
+{
+  if (xyz.size() != 3*Z.size())
+  {
+    throw std::invalid_argument("xyz must be 3 x length(Z)");
+  }
+  xyz::Reader reader(view(s), offset);
+  if (reader.next(Z.data(), xyz.data(), Z.size()) != long(Z.size()))
+  {
+    throw std::invalid_argument("Z and xyz must have the size of the frame");
+  }
+  return reader.offset();
 }
 
 JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
 {
   mod.method("read_string", &read_string);
-  //mod.method("echo_string", &echo_string);
+  mod.method("echo_string", &echo_string);
+  mod.method("xyz_natoms", &xyz_natoms);
+  mod.method("xyz_read", &xyz_read);
 }
-
@@ -1,11 +1,66 @@
+
 # Load the module and generate the functions
 module CppString
   using CxxWrap
+  import Mmap
   @wrapmodule(joinpath(@__DIR__, "build/lib/libtestlib"))
 
   function __init__()
     @initcxx
   end
+
+  # The bytes of s as a Vector{UInt8} over the memory of s itself, with no
+  # copy (std::string_view in testlib.cpp); valid while s is preserved
+  bytes(s::String) = unsafe_wrap(Vector{UInt8}, pointer(s), sizeof(s))
+
+  read_string(s::String) = GC.@preserve s read_string(bytes(s))
+  echo_string(s::String) = GC.@preserve s String(echo_string(bytes(s)))
+
+  # The XYZ frame at byte `offset` of text into the preallocated Z and the
+  # 3×natoms xyz; returns the offset of the next frame
+  function read_xyz!(Z::Vector{Int32}, xyz::Matrix{Float64}, text::Vector{UInt8}, offset=0)
+    xyz_read(text, offset, Z, xyz)
+  end
+  read_xyz!(Z, xyz, text::String, offset=0) =
+    GC.@preserve text read_xyz!(Z, xyz, bytes(text), offset)
+
+  # All frames of an XYZ text as (Z, xyz)
+  function read_xyz(text::Vector{UInt8})
+    frames = Tuple{Vector{Int32},Matrix{Float64}}[]
+    offset = 0
+    while (n = xyz_natoms(text, offset)) ≥ 0
+      Z, xyz = Vector{Int32}(undef, n), Matrix{Float64}(undef, 3, n)
+      offset = read_xyz!(Z, xyz, text, offset)
+      push!(frames, (Z, xyz))
+    end
+    frames
+  end
+  read_xyz(text::String) = GC.@preserve text read_xyz(bytes(text))
+
+  # Same for a file, memory-mapped rather than read
+  read_xyz_file(filename) = open(io -> read_xyz(Mmap.mmap(io)), filename)
 end
+using .CppString
 
 @assert CppString.read_string("asd") == 3
+@assert CppString.read_string("αβγ") == 6    # bytes, as std::string::length
+@assert CppString.echo_string("asd") == "asd"
+
+# Geometries in place: symbols or atomic numbers, several frames
+frames = CppString.read_xyz_file(joinpath(@__DIR__, "..", "..", "data", "acetaldehyde.xyz"))
+@assert length(frames) == 1
+Z, xyz = only(frames)
+@assert Z == [6, 6, 8, 1, 1, 1, 1] && size(xyz) == (3, 7)
+@assert xyz[:, 2] ≈ [0.0, 0.0, 2.845112131228]
+
+h2 = read(joinpath(@__DIR__, "..", "..", "data", "h2.xyz"), String)
+trajectory = h2 * "\n" * replace(h2, "1.4" => "1.5")
+frames = CppString.read_xyz(trajectory)
+@assert length(frames) == 2 && all(Z == [1, 1] for (Z, _) in frames)
+@assert frames[2][2][:, 2] == [0.0, 0.0, 1.5]
+
+# Reusing preallocated arrays, frame by frame
+Z, xyz = Vector{Int32}(undef, 2), Matrix{Float64}(undef, 3, 2)
+offset = CppString.read_xyz!(Z, xyz, trajectory)
+CppString.read_xyz!(Z, xyz, trajectory, offset)
+@assert Z == [1, 1] && xyz[3, 2] == 1.5
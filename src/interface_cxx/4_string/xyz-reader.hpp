@@ -0,0 +1,174 @@
+// Streaming reader of XYZ geometries (src/data/*.xyz) over a
+// std::string_view, e.g. the bytes of a Julia String or a memory-mapped
+// file: frames are parsed in place, with no copies and no allocations, into
+// arrays given by the caller.
+//
+//   natoms
+//   comment
+//   symbol-or-Z  x  y  z  [ignored]
+//   ...
+//
+// A file may hold several such frames (a trajectory), blank lines between
+// them are allowed.
+
+#ifndef XYZ_READER_HPP
+#define XYZ_READER_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace xyz
+{
+
+class ParseError : public std::runtime_error
+{
+public:
+  ParseError(const std::string& what, std::size_t line)
+    : std::runtime_error("xyz, line " + std::to_string(line) + ": " + what) {}
+};
+
+// Atomic number of an element symbol, or of a number given as such (both
+// are found in XYZ files); 0 if unknown
+inline int atomic_number(std::string_view symbol)
+{
+  static constexpr const char* elements[] = {
+    "H",                                                                                  "He",
+    "Li", "Be",                                                  "B",  "C",  "N",  "O",  "F",  "Ne",
+    "Na", "Mg",                                                  "Al", "Si", "P",  "S",  "Cl", "Ar",
+    "K",  "Ca", "Sc", "Ti", "V",  "Cr", "Mn", "Fe", "Co", "Ni", "Cu", "Zn", "Ga", "Ge", "As", "Se", "Br", "Kr",
+    "Rb", "Sr", "Y",  "Zr", "Nb", "Mo", "Tc", "Ru", "Rh", "Pd", "Ag", "Cd", "In", "Sn", "Sb", "Te", "I",  "Xe",
+    "Cs", "Ba", "La", "Ce", "Pr", "Nd", "Pm", "Sm", "Eu", "Gd", "Tb", "Dy", "Ho", "Er", "Tm", "Yb",
+                      "Lu", "Hf", "Ta", "W",  "Re", "Os", "Ir", "Pt", "Au", "Hg", "Tl", "Pb", "Bi", "Po", "At", "Rn"};
+  constexpr int nelements = sizeof(elements)/sizeof(elements[0]);
+
+  int z = 0;
+  const auto [end, ec] = std::from_chars(symbol.data(), symbol.data() + symbol.size(), z);
+  if (ec == std::errc() && end == symbol.data() + symbol.size())
+  {
+    return (0 < z && z <= nelements) ? z : 0;
+  }
+  for (int k = 0; k < nelements; k++)
+  {
+    if (symbol == elements[k]) return k + 1;
+  }
+  return 0;
+}
+
+class Reader
+{
+public:
+  // Reads text from byte `offset` on, e.g. where a previous Reader stopped
+  explicit Reader(std::string_view text, std::size_t offset = 0)
+    : text_(text), pos_(offset), line_(0)
+  {
+    if (offset > text.size()) throw std::out_of_range("xyz: offset past the end");
+  }
+
+  // Number of atoms of the next frame, or -1 if only blank lines are left
+  long natoms()
+  {
+    skip_blank_lines();
+    if (pos_ == text_.size()) return -1;
+    const std::size_t pos = pos_, line = line_;
+    std::string_view l = next_line();
+    const long n = parse<long>(next_field(l), "number of atoms");
+    pos_ = pos;
+    line_ = line;
+    if (n < 0) throw ParseError("negative number of atoms", line_ + 1);
+    return n;
+  }
+
+  // Next frame into Z[n] and the column-major 3 x n matrix xyz, with room for
+  // `capacity` atoms; returns n, or -1 at the end of the text
+  long next(std::int32_t* Z, double* xyz, long capacity)
+  {
+    const long n = natoms();
+    if (n < 0) return -1;
+    if (n > capacity) throw ParseError("frame larger than the arrays given", line_ + 1);
+    next_line();   // natoms
+    if (pos_ == text_.size()) throw ParseError("missing comment line", line_ + 1);
+    next_line();   // comment, ignored
+    for (long i = 0; i < n; i++)
+    {
+      if (pos_ == text_.size()) throw ParseError("missing atoms", line_ + 1);
+      std::string_view l = next_line();
+      const std::string_view symbol = next_field(l);
+      Z[i] = atomic_number(symbol);
+      if (Z[i] == 0) throw ParseError("unknown element '" + std::string(symbol) + "'", line_);
+      for (int k = 0; k < 3; k++)
+      {
+        xyz[3*i + k] = parse<double>(next_field(l), "coordinate");
+      }
+    }
+    return n;
+  }
+
+  // Byte where the next frame starts
+  std::size_t offset() const { return pos_; }
+
+private:
+  // Line from pos_ on, without its end (\n or \r\n)
+  std::string_view next_line()
+  {
+    std::size_t end = text_.find('\n', pos_);
+    if (end == std::string_view::npos) end = text_.size();
+    std::string_view l = text_.substr(pos_, end - pos_);
+    if (!l.empty() && l.back() == '\r') l.remove_suffix(1);
+    pos_ = end < text_.size() ? end + 1 : end;
+    line_++;
+    return l;
+  }
+
+  void skip_blank_lines()
+  {
+    while (pos_ < text_.size())
+    {
+      const std::size_t end = text_.find('\n', pos_);
+      const std::string_view l = text_.substr(pos_, end == std::string_view::npos ? end : end - pos_);
+      if (l.find_first_not_of(" \t\r") != std::string_view::npos) return;
+      pos_ = end == std::string_view::npos ? text_.size() : end + 1;
+      line_++;
+    }
+  }
+
+  // First whitespace-separated field of l, which is advanced past it
+  static std::string_view next_field(std::string_view& l)
+  {
+    const std::size_t begin = l.find_first_not_of(" \t");
+    if (begin == std::string_view::npos)
+    {
+      l = std::string_view();
+      return l;
+    }
+    std::size_t end = l.find_first_of(" \t", begin);
+    if (end == std::string_view::npos) end = l.size();
+    const std::string_view field = l.substr(begin, end - begin);
+    l.remove_prefix(end);
+    return field;
+  }
+
+  template<typename T>
+  T parse(std::string_view field, const char* what) const
+  {
+    T value{};
+    if (field.size() > 1 && field[0] == '+') field.remove_prefix(1);   // not taken by from_chars
+    const auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (field.empty() || ec != std::errc() || end != field.data() + field.size())
+    {
+      throw ParseError(std::string("bad ") + what + " '" + std::string(field) + "'", line_);
+    }
+    return value;
+  }
+
+  std::string_view text_;
+  std::size_t pos_;
+  std::size_t line_;   // lines read so far, for the messages
+};
+
+} // namespace xyz
+
+#endif
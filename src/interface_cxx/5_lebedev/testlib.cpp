@@ -0,0 +1,32 @@
+#include <stdexcept>
+#include <string>
+
+#include "jlcxx/jlcxx.hpp"
+#include "jlcxx/const_array.hpp"
+
+#include "lebedev-laikov.h"
+
+// The grids live in static read-only storage (see lebedev-laikov-table.cpp),
+// so they can be handed to Julia as ConstArrays without copying.
+// Y, Z and W follow X contiguously: the first 3*order doubles are the
+// column-major order x 3 matrix [x y z].
+const double* lebedev_table(const int64_t order)
+{
+  const double *x, *y, *z, *w;
+  if (ld_table_by_order(order, &x, &y, &z, &w) != order)
+  {
+    throw std::invalid_argument("No Lebedev-Laikov rule with " +
+                                std::to_string(order) + " points");
+  }
+  return x;
+}
+
+JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
+{
+  mod.method("lebedev_points", [](const int64_t order) {
+        return jlcxx::make_const_array(lebedev_table(order), order, 3);
+      });
+  mod.method("lebedev_weights", [](const int64_t order) {
+        return jlcxx::make_const_array(lebedev_table(order) + 3*order, order);
+      });
+}
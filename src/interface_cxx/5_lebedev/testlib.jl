@@ -0,0 +1,21 @@
+
+# Load the module and generate the functions
+module CppLebedev
+  using CxxWrap
+  @wrapmodule(joinpath(@__DIR__, "build/lib/libtestlib"))
+
+  function __init__()
+    @initcxx
+  end
+end
+using .CppLebedev
+
+# Points are a read-only 302 × 3 [x y z] view of the static table
+points  = CppLebedev.lebedev_points(302)
+weights = CppLebedev.lebedev_weights(302)
+@assert size(points) == (302, 3)
+@assert sum(weights) ≈ 1
+@assert all(sum(abs2, points, dims=2) .≈ 1)
+
+# Unknown orders are reported as Julia errors
+@assert try CppLebedev.lebedev_weights(7); false catch; true end
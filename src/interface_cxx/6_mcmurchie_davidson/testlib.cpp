@@ -0,0 +1,71 @@
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "jlcxx/jlcxx.hpp"
+#include "jlcxx/stl.hpp"
+
+#include "boys.hpp"
+#include "eri-driver.hpp"
+#include "mcmurchie-davidson.hpp"
+
+// Copy of a SciAlgs.McMurchieDavidson.BasisFunction (normalize_basis! applied)
+mmd::BasisFunction basis_function(jlcxx::ArrayRef<double> origin,
+                                  const int64_t l, const int64_t m, const int64_t n,
+                                  jlcxx::ArrayRef<double> exps,
+                                  jlcxx::ArrayRef<double> coefs,
+                                  jlcxx::ArrayRef<double> norm)
+{
+  mmd::BasisFunction bf;
+  bf.origin = {origin[0], origin[1], origin[2]};
+  bf.shell = {int(l), int(m), int(n)};
+  bf.exps.assign(exps.begin(), exps.end());
+  bf.coefs.assign(coefs.begin(), coefs.end());
+  bf.norm.assign(norm.begin(), norm.end());
+  return bf;
+}
+
+JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
+{
+  mod.add_type<mmd::BasisFunction>("BasisFunction");
+  mod.method("basis_function", &basis_function);
+
+  // Hermite tables of a pair, to be reused for many integrals
+  mod.add_type<mmd::ShellPair>("ShellPair")
+    .constructor<const mmd::BasisFunction&, const mmd::BasisFunction&>();
+
+  mod.method("S", [](const mmd::BasisFunction& a, const mmd::BasisFunction& b) {
+        return mmd::overlap(a, b);
+      });
+  mod.method("T", [](const mmd::BasisFunction& a, const mmd::BasisFunction& b) {
+        return mmd::kinetic(a, b);
+      });
+  mod.method("V", [](const mmd::BasisFunction& a, const mmd::BasisFunction& b,
+                     jlcxx::ArrayRef<double> C) {
+        return mmd::nuclear_attraction(a, b, {C[0], C[1], C[2]});
+      });
+  mod.method("ERI", [](const mmd::BasisFunction& a, const mmd::BasisFunction& b,
+                       const mmd::BasisFunction& c, const mmd::BasisFunction& d) {
+        return mmd::electron_repulsion(a, b, c, d);
+      });
+  mod.method("ERI", [](const mmd::ShellPair& ab, const mmd::ShellPair& cd) {
+        return mmd::electron_repulsion(ab, cd);
+      });
+
+  // Schwarz-screened unique ERIs of a basis, at eri_index(i, j, k, l) + 1;
+  // nthreads = 0 uses all cores
+  mod.method("ERI_unique", [](const std::vector<mmd::BasisFunction>& basis,
+                              const double threshold, const int64_t nthreads) {
+        return mmd::electron_repulsion_unique(basis, threshold, nthreads);
+      });
+
+  // F[i, n+1] = F_n(T[i]) for n = 0:nmax, into a length(T) × (nmax+1) matrix
+  mod.method("boys!", [](jlcxx::ArrayRef<double,2> F, const int64_t nmax,
+                         jlcxx::ArrayRef<double> T) {
+        if (nmax < 0 || F.size() != T.size()*(nmax + 1))
+        {
+          throw std::invalid_argument("F must be a length(T) × (nmax+1) matrix");
+        }
+        mmd::boys_batch(nmax, T.size(), T.data(), F.data());
+      });
+}
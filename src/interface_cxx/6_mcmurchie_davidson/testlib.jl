@@ -0,0 +1,65 @@
+
+# Load the module and generate the functions
+module CppMcMurchieDavidson
+  using CxxWrap
+  @wrapmodule(joinpath(@__DIR__, "build/lib/libtestlib"))
+
+  function __init__()
+    @initcxx
+  end
+end
+using .CppMcMurchieDavidson
+using CxxWrap: StdVector
+
+using SciAlgs.McMurchieDavidson: BasisFunction, normalize_basis!, S, T, V, ERI, F_boys,
+                                 twoe_iterator
+
+# Native copy of a (normalized) Julia basis function
+cxx(bf::BasisFunction) = CppMcMurchieDavidson.basis_function(Float64.(bf.origin), bf.shell...,
+                                                             bf.exps, bf.coefs, bf.norm)
+
+s = BasisFunction([1.0, 2.0, 3.0], (0,0,0), [3.42525091, 0.62391373, 0.16885540],
+                  [0.15432897, 0.53532814, 0.44463454], missing)
+px = BasisFunction([0.0, 0.5, -0.3], (1,0,0), [2.9, 0.8], [0.4, 0.7], missing)
+dxy = BasisFunction([0.2, -0.4, 0.9], (1,1,0), [1.3, 0.45], [0.6, 0.5], missing)
+foreach(normalize_basis!, (s, px, dxy))
+
+# Same integrals as the recursive Julia implementation
+C = [1.0, 0.0, 0.0]
+for (a, b) in ((s, s), (px, dxy), (dxy, dxy))
+   @assert CppMcMurchieDavidson.S(cxx(a), cxx(b)) ≈ S(a, b)
+   @assert CppMcMurchieDavidson.T(cxx(a), cxx(b)) ≈ T(a, b)
+   @assert CppMcMurchieDavidson.V(cxx(a), cxx(b), C) ≈ V(a, b, C)
+end
+@assert CppMcMurchieDavidson.ERI(cxx(s), cxx(s), cxx(s), cxx(s)) ≈ 0.7746059439198977
+@assert CppMcMurchieDavidson.ERI(cxx(px), cxx(s), cxx(dxy), cxx(px)) ≈ ERI(px, s, dxy, px)
+
+# Shell pairs keep their Hermite tables between integrals
+ab = CppMcMurchieDavidson.ShellPair(cxx(px), cxx(dxy))
+@assert CppMcMurchieDavidson.ERI(ab, ab) ≈ ERI(px, dxy, px, dxy)
+
+# Batched Boys function, all orders up to nmax for every T
+Ts = [0.0, 1e-8, 0.05, 0.73, 4.2, 17.0, 120.0]
+nmax = 8
+F = zeros(length(Ts), nmax + 1)
+CppMcMurchieDavidson.boys!(F, nmax, Ts)
+@assert isapprox(F[1:end-1,:], [F_boys(n, t) for t in Ts[1:end-1], n in 0:nmax], rtol=1e-12)
+# F_n(T) → (2n-1)!!/2^(n+1) √(π/T^(2n+1)) for large T
+@assert F[end,:] ≈ [prod(1:2:2n-1)/2^(n+1)*√(π/120.0^(2n+1)) for n in 0:nmax]
+
+# Unique integrals of a basis, Schwarz-screened and computed in parallel;
+# (ij|kl) of twoe_iterator is at eri_index(i,j,k,l)
+pair_index(i, j) = i ≥ j ? i*(i-1)÷2 + j : j*(j-1)÷2 + i         # 1-based
+eri_index(i, j, k, l) = pair_index(pair_index(i, j), pair_index(k, l))
+
+far_s = BasisFunction([30.0, 0.0, 0.0], (0,0,0), [3.42525091, 0.62391373, 0.16885540],
+                      [0.15432897, 0.53532814, 0.44463454], missing)
+normalize_basis!(far_s)
+basis = [s, px, dxy, far_s]
+threshold = 1e-10
+eri = CppMcMurchieDavidson.ERI_unique(StdVector(cxx.(basis)), threshold, 0)
+@assert length(eri) == length(twoe_iterator(length(basis)))
+for (i,j,k,l) in twoe_iterator(length(basis))
+   @assert isapprox(eri[eri_index(i,j,k,l)], ERI(basis[i],basis[j],basis[k],basis[l]),
+                    atol=threshold)
+end
@@ -5,7 +5,8 @@
 const FORTLIB    = joinpath(@__DIR__, "fortranlib.so")
 const FORTSOURCE = joinpath(@__DIR__, "fortran_iso_c.f90")
 
-run(`gfortran -Wall -shared -O2 -fPIC -o $FORTLIB $FORTSOURCE`)
+# -fopenmp-simd: the SIMD loop of mypow_batch
+run(`gfortran -Wall -shared -O3 -fopenmp-simd -fPIC -o $FORTLIB $FORTSOURCE`)
 
 # Fortran passes all the arguments by reference, so we have to
 # use references of the appropriate type.
@@ -28,6 +29,13 @@ end
 @assert v[] == 4
 println("Four = ",v[])
 
+# Whole arrays in one call; n is passed by value (VALUE attribute)
+xs = collect(Clonglong, 1:1000)
+squares = similar(xs)
+@ccall FORTLIB.mypow_batch(xs::Ptr{Clonglong}, squares::Ptr{Clonglong},
+                           length(xs)::Int64)::Cvoid
+@assert squares == xs .^ 2
+
 
 # TODO give examples of all combinations possible:
 #      * subroutine call passing integer by reference (inout)
@@ -1,4 +1,3 @@
-
 module basic_math
 contains
 
@@ -11,4 +10,22 @@ contains
 
   end subroutine mypow
 
+  ! Batched mypow, out(i) = val(i)**2, one call for whole arrays: the same
+  ! ABI as the other batched interop kernels (C mean_batch, Rust
+  ! double_input_batch), inputs, outputs and the length by value
+  subroutine mypow_batch(val, out, n) bind(C, name='mypow_batch')
+
+    use iso_c_binding
+    integer(c_int64_t), value                   :: n
+    integer(c_long_long), dimension(n), intent(in)  :: val
+    integer(c_long_long), dimension(n), intent(out) :: out
+    integer(c_int64_t) :: i
+
+    !$omp simd
+    do i = 1, n
+      out(i) = val(i) ** 2
+    end do
+
+  end subroutine mypow_batch
+
 end module basic_math
@@ -11,6 +11,13 @@ output =  ccall(   #(:function or "function", "library"), Return type, (Input ty
 println()
 println("The result of $input * 2 is $output.")
 
+# Whole arrays in one call
+inputs = collect(Int32, 1:1000)
+outputs = similar(inputs)
+@ccall RUSTLIB.double_input_batch(inputs::Ptr{Int32}, outputs::Ptr{Int32},
+                                  length(inputs)::Int64)::Cvoid
+@assert outputs == 2 .* inputs
+
 println()
 v = zeros(3)
 @ccall RUSTLIB.modify_vectorf64(v::Ptr{Float64},
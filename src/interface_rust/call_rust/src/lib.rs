@@ -7,6 +7,24 @@ pub extern fn double_input(input: i32) -> i32 {
     input * 2
 }
 
+// Batched double_input: output[i] = 2 input[i] for whole arrays in one
+// call, with the ABI of the other batched interop kernels (C mean_batch,
+// Fortran mypow_batch): inputs, outputs, i64 length. The loop over slices
+// has no bounds checks left, so it is vectorised.
+#[no_mangle]
+pub extern fn double_input_batch(input: *const i32, output: *mut i32, len: i64) {
+    if len <= 0 {
+        return;
+    }
+    let (input, output) = unsafe {
+        (std::slice::from_raw_parts(input, len as usize),
+         std::slice::from_raw_parts_mut(output, len as usize))
+    };
+    for (o, i) in output.iter_mut().zip(input) {
+        *o = i.wrapping_mul(2);
+    }
+}
+
 // Take a pointer to the first element of a C array
 // with len elements of type f64, assuming some properties (unsafe)
 #[no_mangle]
@@ -40,6 +58,15 @@ mod tests {
         assert_eq!(double_input(2), 4);
     }
 
+    #[test]
+    fn test_double_input_batch() {
+        let input = [1, -2, 3, 40];
+        let mut output = [0; 4];
+        double_input_batch(input.as_ptr(), output.as_mut_ptr(), 4);
+        assert_eq!(output, [2, -4, 6, 80]);
+        double_input_batch(input.as_ptr(), output.as_mut_ptr(), 0);
+    }
+
     #[test]
     fn test_modify_vectorf64() {
         let mut v = array![0.0,0.0,0.0];
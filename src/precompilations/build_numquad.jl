@@ -0,0 +1,50 @@
+
+# System image of SciAlgs for short jobs, with the native libraries prebuilt
+# and the call paths of precompile_numquad.jl compiled in: no runtime gcc step
+# and no JIT latency for the first grid or integral. Once, from the repository
+# root:
+#    julia --project=src/precompilations -e 'using Pkg; Pkg.develop(path="."); Pkg.instantiate()'
+# then
+#    julia --project=src/precompilations src/precompilations/build_numquad.jl
+# and start Julia with preload_numquad.sh (from this directory).
+#
+# The library paths are resolved when the image is built: rebuild it after
+# changing the native sources or moving the repository.
+using PackageCompiler
+import CxxWrap
+import Libdl
+
+const REPO       = normpath(joinpath(@__DIR__, "..", ".."))
+const LEBEDEV    = joinpath(REPO, "src", "NumQuad", "lebedev")
+const CPPLEBEDEV = joinpath(REPO, "src", "interface_cxx", "5_lebedev")
+const SYSIMAGE   = joinpath(@__DIR__, "sys_numquad." * Libdl.dlext)
+
+# liblebedev with CMake: then NumQuad loads it as LIBLEBEDEV_PREBUILT instead
+# of compiling its own copy
+function cmake(source, build, options...)
+   run(`cmake -S $source -B $build -DCMAKE_BUILD_TYPE=Release $options`)
+   run(`cmake --build $build --config Release`)
+end
+cmake(LEBEDEV, joinpath(LEBEDEV, "build"))
+
+# CxxWrap wrapper of the same tables, against the libcxxwrap_julia of this
+# environment (5_lebedev/build.sh has a machine specific path)
+try
+   cmake(CPPLEBEDEV, joinpath(CPPLEBEDEV, "build"),
+         "-DCMAKE_PREFIX_PATH=$(CxxWrap.prefix_path())")
+catch e
+   @warn "CxxWrap module of 5_lebedev not built, left out of the workload" exception=e
+end
+
+create_sysimage(["SciAlgs", "CxxWrap"];
+                sysimage_path = SYSIMAGE,
+                precompile_execution_file = joinpath(@__DIR__, "precompile_numquad.jl"))
+
+# Time to first result with the new image
+first_result = """
+   @time using SciAlgs
+   @time SciAlgs.NumQuad.lebedev_laikov_wrapper(302)
+   @time SciAlgs.NumQuad.molecular_grid([0.0 0.0 0.0; 0.0 0.0 1.4], 30, 110)
+"""
+julia = joinpath(Sys.BINDIR, Base.julia_exename())
+run(`$julia --sysimage $SYSIMAGE --project=$(Base.active_project()) -e $first_result`)
@@ -0,0 +1,42 @@
+
+# Workload of build_numquad.jl: the grid, reduction and integral call paths
+# of a short job, so that their first call is compiled into the sysimage
+using SciAlgs
+using SciAlgs.NumQuad: lebedev_laikov_wrapper, lebedev_laikov_table,
+                       lebedev_laikov_spherical, lebedev_laikov_padded,
+                       lebedev_order_by_precision, atomic_grid, molecular_grid,
+                       grid_integrate, reproducible_sum, reproducible_dot,
+                       pruned_orders, sg1_partition, pruned_molecular_grid,
+                       perez_jorda, gauss_chebyshev2nd
+
+for n in (6, 302, 5810)
+   points, weights = lebedev_laikov_wrapper(n)
+   grid_integrate(weights, points[:, 3] .^ 2)
+   lebedev_laikov_table(n)
+   lebedev_laikov_spherical(n)
+   lebedev_laikov_spherical(n, degrees=true)
+   lebedev_laikov_padded(n)
+end
+lebedev_order_by_precision(11)
+
+perez_jorda(20)
+gauss_chebyshev2nd(20)
+points, weights = atomic_grid(110, 30)
+points, weights = molecular_grid([0.0 0.0 0.0; 0.0 0.0 1.4], 30, 110)
+grid_integrate(weights, exp.(-vec(sum(abs2, points, dims=2))))
+points, weights = pruned_molecular_grid([0.0 0.0 0.0; 0.0 0.0 1.4], 50,
+                                        pruned_orders(50, sg1_partition(1)...))
+x = rand(10^5)
+reproducible_sum(x)
+reproducible_dot(x, x)
+
+redirect_stdout(devnull) do
+   SciAlgs.hartree_fock([0.0, 1.4632], [2, 1])
+   SciAlgs.hartree_fock([0.0, 1.4632], [2, 1], direct=true)
+end
+
+# CxxWrap module of src/interface_cxx/5_lebedev, when it has been built
+const CPPLEBEDEV = joinpath(@__DIR__, "..", "interface_cxx", "5_lebedev")
+if isdir(joinpath(CPPLEBEDEV, "build", "lib"))
+   include(joinpath(CPPLEBEDEV, "testlib.jl"))
+end
@@ -0,0 +1,2 @@
+
+julia --sysimage sys_numquad.so --project=. "$@"
@@ -2,6 +2,7 @@ using Test
 
 include("test_car2int.jl")
 include("test_io.jl")
+include("test_binary_cache.jl")
 include("test_validate_dni.jl")
 include("test_validate_isbn.jl")
 
@@ -18,6 +19,8 @@ include("test_gauss_chebyshev2nd.jl")
 include("test_euler_mclaurin.jl")
 include("test_trapezoidal.jl")
 include("test_lebedev_laikov.jl")
+include("test_lebedev_laikov_table.jl")
+include("test_molecular_grid.jl")
 
 # Algorithms from THE BOOK
 include("test_archimedes.jl")
@@ -0,0 +1,39 @@
+using SciAlgs: write_cache, map_cache, cached, CacheFormatError, hartree_fock
+
+@testset "I/O: memory-mapped binary cache" begin
+
+   mktempdir() do dir
+      file = joinpath(dir, "grid.cache")
+      x, w = rand(110, 3), rand(110)
+      eri = rand(4, 4, 4, 4)
+      write_cache(file, ["points" => x, "weights" => w, "eri" => eri,
+                         "orders" => Int32[6, 14, 26], "phases" => rand(ComplexF64, 5)])
+
+      sections = map_cache(file, verify=true)
+      @test sections["points"] == x && sections["weights"] == w && sections["eri"] == eri
+      @test sections["orders"] == Int32[6, 14, 26] && eltype(sections["phases"]) == ComplexF64
+      @test size(sections["eri"]) == (4, 4, 4, 4)
+
+      # warm start: compute() only runs for a missing or stale file
+      calls = Ref(0)
+      compute() = (calls[] += 1; ("w" => w,))
+      other = joinpath(dir, "other.cache")
+      @test cached(compute, other, key=[1.0, 2.0])["w"] == w
+      @test cached(compute, other, key=[1.0, 2.0])["w"] == w
+      @test calls[] == 1
+      cached(compute, other, key=[1.0, 3.0])
+      @test calls[] == 2
+
+      # not a cache (of this version)
+      write(file, "not a cache file, but long enough to hold a header of sixty-four bytes")
+      @test_throws CacheFormatError map_cache(file)
+      @test (@test_logs (:warn,) cached(compute, file))["w"] == w
+
+      # SCF from the cached two-electron integrals
+      eri_file = joinpath(dir, "heh.cache")
+      E = hartree_fock([0., 1.4632], [2, 1])
+      @test all(hartree_fock([0., 1.4632], [2, 1], cache=eri_file) .≈ E)
+      @test all(hartree_fock([0., 1.4632], [2, 1], cache=eri_file) .≈ E)
+      @test map_cache(eri_file)["key"] == [0., 1.4632, 2, 1]
+   end
+end
@@ -4,6 +4,7 @@
 
    include("../src/interface_fortran/iso_c/callfortran.jl")
    @test v[] == 4
+   @test squares == xs .^ 2
 
 end
 
@@ -1,4 +1,5 @@
 
+using SciAlgs
 using SciAlgs: hartree_fock
 
 @testset "Hartree-Fock: Szabo-Ostlund book" begin
@@ -12,5 +13,35 @@ using SciAlgs: hartree_fock
    total_energy, electronic_energy = hartree_fock([0., 1.4632], [2, 1])
    szabo_energy = -4.227529
    @test isapprox(electronic_energy,szabo_energy,atol=1e-6)
-end
 
+   # Direct SCF (no stored integrals, incremental Fock builds): same energies
+   for (R, Z) in [([0., 1.4], [1, 1]), ([0., 1.4632], [2, 1]), ([0., 1.4, 2.8], [1, 1, 1])]
+      total_energy, electronic_energy = hartree_fock(R, Z)
+      total_direct, electronic_direct = hartree_fock(R, Z, direct=true)
+      @test isapprox(total_direct, total_energy, atol=1e-10)
+      @test isapprox(electronic_direct, electronic_energy, atol=1e-10)
+   end
+
+   # Batched contractions over whole STONG functions = primitive-pair sums
+   b = [SciAlgs.sto3g_helium(0.), SciAlgs.sto3g_hydrogen(1.4632)]
+   pairsum(f, b1, b2) = sum(b1.d[p]*b2.d[q]*f(b1.g[p], b2.g[q]) for p in 1:3, q in 1:3)
+   # HeH+ one-electron integrals, Szabo-Ostlund §3.5.3
+   @test isapprox(SciAlgs.overlap_integral(b[1], b[2]), 0.4508, atol=1e-4)
+   @test isapprox(SciAlgs.kinetic_energy_integral(b[1], b[1]), 2.1643, atol=1e-4)
+   @test isapprox(SciAlgs.kinetic_energy_integral(b[1], b[2]), 0.1670, atol=1e-4)
+   @test isapprox(SciAlgs.kinetic_energy_integral(b[2], b[2]), 0.7600, atol=1e-4)
+   for b1 in b, b2 in b
+      @test SciAlgs.overlap_integral(b1, b2) ≈
+            pairsum(SciAlgs.overlap_integral, b1, b2)
+      @test SciAlgs.kinetic_energy_integral(b1, b2) ≈
+            pairsum(SciAlgs.kinetic_energy_integral, b1, b2)
+      @test SciAlgs.nuclear_attraction_integral(2, 0., b1, b2) ≈
+            pairsum((g1, g2) -> SciAlgs.nuclear_attraction_integral(2, 0., g1, g2), b1, b2)
+      for b3 in b, b4 in b
+         @test SciAlgs.two_electron_integral(b1, b2, b3, b4) ≈
+               sum(b1.d[p]*b2.d[q]*b3.d[r]*b4.d[s]*
+                   SciAlgs.two_electron_integral(b1.g[p], b2.g[q], b3.g[r], b4.g[s])
+                   for p in 1:3, q in 1:3, r in 1:3, s in 1:3)
+      end
+   end
+end
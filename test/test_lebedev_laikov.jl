@@ -47366,3 +47366,56 @@ using SciAlgs.NumQuad: lebedev_laikov_spherical
    @test isapprox(w, w_ref, atol=1.0e-10)
 
 end
+
+using SciAlgs.NumQuad: lebedev_instrument_enabled, lebedev_instrument_stats,
+                       lebedev_instrument_reset, lebedev_trace, lebedev_laikov_table
+
+@testset "Lebedev-Laikov: native instrumentation" begin
+
+   lebedev_instrument_reset()
+   trace = tempname() * ".json"
+   lebedev_trace(trace) do
+      for _ in 1:5
+         lebedev_laikov_table(110)
+      end
+   end
+   stats = Dict(s.name => s for s in lebedev_instrument_stats())
+   @test haskey(stats, "ld_table_by_order") && haskey(stats, "molecular_grid")
+   calls = stats["ld_table_by_order"].calls
+   if lebedev_instrument_enabled()
+      @test calls == 5 == sum(stats["ld_table_by_order"].histogram)
+      @test stats["ld_table_by_order"].seconds > 0
+      @test count("\"ld_table_by_order\"", read(trace, String)) == 5
+   else
+      # compiled out: no probes at all
+      @test calls == 0 && all(s.calls == 0 for s in values(stats))
+   end
+   lebedev_instrument_reset()
+   @test all(s.calls == 0 for s in lebedev_instrument_stats())
+   rm(trace, force=true)
+end
+
+using SciAlgs.NumQuad: reproducible_sum, reproducible_dot, reproducible_norm,
+                       grid_integrate, lebedev_laikov_wrapper
+
+@testset "Lebedev-Laikov: reproducible native reductions" begin
+
+   x = (rand(1_000_003) .- 0.5) .* 10.0 .^ rand(-8:8, 1_000_003)
+   y = rand(1_000_003)
+   s, d = reproducible_sum(x, nthreads=1), reproducible_dot(x, y, nthreads=1)
+   for nthreads in (2, 3, 4, 7)
+      # same bits, not just close
+      @test reproducible_sum(x, nthreads=nthreads) === s
+      @test reproducible_dot(x, y, nthreads=nthreads) === d
+   end
+   # compensated: errors of the order of ε Σ|x|, far below the naive √n ε Σ|x|
+   @test abs(s - sum(big.(x))) ≤ 1e-15 * sum(abs, x)
+   @test abs(d - sum(big.(x) .* big.(y))) ≤ 1e-15 * sum(abs.(x .* y))
+   @test reproducible_norm([3.0, 4.0]) == 5
+   @test reproducible_sum(Float64[]) == 0
+
+   _, weights = lebedev_laikov_wrapper(302)
+   @test grid_integrate(weights) ≈ 1
+   @test grid_integrate(weights, fill(2.0, 302)) ≈ 2
+   @test_throws DimensionMismatch grid_integrate(weights, y)
+end
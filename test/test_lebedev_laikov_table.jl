@@ -0,0 +1,116 @@
+
+using SciAlgs.NumQuad: lebedev_laikov_table, LIBLEBEDEV
+
+@testset "Lebedev-Laikov compile-time tables" begin
+
+   for n in [6,    14,   26,   38,   50,   74,   86,   110,  146,  170,  194,
+             230,  266,  302,  350,  434,  590,  770,  974,  1202, 1454, 1730,
+             2030, 2354, 2702, 3074, 3470, 3890, 4334, 4802, 5294, 5810]
+
+      points, w = lebedev_laikov_table(n)
+
+      # Same grid as generated at runtime by gen_oh
+      x, y, z, v = zeros(n), zeros(n), zeros(n), zeros(n)
+      status = ccall((:ld_by_order, LIBLEBEDEV), Cint,
+                     (Cint, Ref{Float64}, Ref{Float64}, Ref{Float64}, Ref{Float64}),
+                     n, x, y, z, v)
+      @test status == 0
+
+      @test size(points) == (n, 3)
+      @test isapprox(points, [x y z], atol=1e-15)
+      @test isapprox(w, v, atol=1e-15)
+      @test sum(w) ≈ 1
+   end
+
+   @test_throws ErrorException lebedev_laikov_table(7)
+end
+
+using SciAlgs.NumQuad: lebedev_laikov_padded
+
+@testset "Lebedev-Laikov aligned and padded grids" begin
+
+   points, weights = lebedev_laikov_table(302)
+   for width in [1, 2, 4, 8]
+      x, y, z, w = lebedev_laikov_padded(302, width=width)
+      len = cld(302, width) * width
+      @test length(x) == length(y) == length(z) == length(w) == len
+      @test all(UInt(pointer(v)) % 64 == 0 for v in (x, y, z, w))
+      @test [x[1:302] y[1:302] z[1:302]] == points
+      @test w[1:302] == weights
+      @test all(w[303:end] .== 0)
+      @test all(abs.(x.^2 .+ y.^2 .+ z.^2 .- 1) .< 1e-14)
+   end
+
+   @test_throws ErrorException lebedev_laikov_padded(302, width=3)
+end
+
+using SciAlgs.NumQuad: lebedev_laikov_orbits
+
+@testset "Lebedev-Laikov orbits" begin
+
+   # x⁴ + y⁴ + z⁴ is invariant under the octahedral group
+   f(x, y, z) = x^4 + y^4 + z^4
+   for n in [14, 302, 590, 5810]
+      points, w = lebedev_laikov_table(n)
+      orbits = lebedev_laikov_orbits(n)
+      @test sum(o.multiplicity for o in orbits) == n
+      @test sum(o.multiplicity * o.w for o in orbits) ≈ 1
+      @test sum(o.multiplicity * o.w * f(o.x, o.y, o.z) for o in orbits) ≈
+            sum(w .* f.(points[:,1], points[:,2], points[:,3]))
+   end
+
+   @test_throws ErrorException lebedev_laikov_orbits(7)
+end
+
+using SciAlgs.NumQuad: lebedev_nearest_order, lebedev_order_by_precision
+
+@testset "Lebedev-Laikov order lookup" begin
+
+   valid_orders = [6,    14,   26,   38,   50,   74,   86,   110,  146,  170,  194,
+                   230,  266,  302,  350,  434,  590,  770,  974,  1202, 1454, 1730,
+                   2030, 2354, 2702, 3074, 3470, 3890, 4334, 4802, 5294, 5810]
+
+   # Same choice as argmin: closest, smallest on ties
+   for n in -2:6000
+      @test lebedev_nearest_order(n) == valid_orders[argmin(abs.(n .- valid_orders))]
+   end
+
+   @test lebedev_order_by_precision(1)   == 6
+   @test lebedev_order_by_precision(29)  == 302
+   @test lebedev_order_by_precision(33)  == 434 # 386 is not available
+   @test lebedev_order_by_precision(131) == 5810
+   @test_throws ErrorException lebedev_order_by_precision(133)
+
+   # Unknown orders are reported, not fatal
+   x = zeros(7)
+   status = ccall((:ld_by_order, LIBLEBEDEV), Cint,
+                  (Cint, Ref{Float64}, Ref{Float64}, Ref{Float64}, Ref{Float64}),
+                  7, x, x, x, x)
+   @test status == -1
+end
+
+using SciAlgs: cart2spherical
+using SciAlgs.NumQuad: lebedev_laikov_spherical, lebedev_xyz_to_tp!
+
+@testset "Lebedev-Laikov batched spherical conversion" begin
+
+   for n in [6, 26, 302, 5810]
+      points, weights = lebedev_laikov_table(n)
+      θ_ref, ϕ_ref = cart2spherical(copy(points))
+
+      θ, ϕ, w = lebedev_laikov_spherical(n)
+      @test isapprox(θ, θ_ref, atol=1e-12)
+      @test isapprox(ϕ, ϕ_ref, atol=1e-12)
+      @test w == weights
+
+      θ, ϕ, _ = lebedev_laikov_spherical(n, degrees=true)
+      @test isapprox(θ, rad2deg.(θ_ref), atol=1e-10)
+      @test isapprox(ϕ, rad2deg.(ϕ_ref), atol=1e-10)
+   end
+
+   # Poles, and the negative x axis with y = ±0, as in xyz_to_tp
+   points = [0.0 0.0 1.0; 0.0 0.0 -1.0; -1.0 0.0 0.0; -1.0 -0.0 0.0]
+   θ, ϕ = lebedev_xyz_to_tp!(zeros(4), zeros(4), points, degrees=true)
+   @test θ ≈ [90, 90, 180, 180]
+   @test ϕ ≈ [0, 180, 90, 90]
+end
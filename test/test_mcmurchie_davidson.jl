@@ -18,6 +18,24 @@ using SciAlgs.McMurchieDavidson: BasisFunction, normalize_basis!,
    @test ERI(a,a,a,a)         ≈ 0.7746059439198977 #|| error("Wrong eri")
 end
 
+@testset "McMurchie-Davidson scheme: p- and d-functions" begin
+
+   # Reference values from the native engine (src/ElStruct/mmd), checked
+   # against an independent implementation
+   s   = BasisFunction([1.0, 2.0, 3.0], (0,0,0), [3.42525091, 0.62391373, 0.16885540],
+                       [0.15432897, 0.53532814, 0.44463454], missing)
+   px  = BasisFunction([0.0, 0.5, -0.3], (1,0,0), [2.9, 0.8], [0.4, 0.7], missing)
+   dxy = BasisFunction([0.2, -0.4, 0.9], (1,1,0), [1.3, 0.45], [0.6, 0.5], missing)
+   dzz = BasisFunction([-0.3, 0.2, 0.4], (0,0,2), [0.9], [1.0], missing)
+   foreach(normalize_basis!, (s, px, dxy, dzz))
+
+   @test S(px,dxy)               ≈ 0.28579351891643096
+   @test T(px,dxy)               ≈ 0.5688240167664548
+   @test V(px,dxy,[1.0,0.0,0.0]) ≈ 0.27714061256323097
+   @test ERI(px,s,s,dxy)         ≈ 0.0007621861329152571
+   @test ERI(dxy,px,dzz,px)      ≈ -0.04020848337305969
+end
+
 using SciAlgs.McMurchieDavidson: twoe_iterator, _twoe_iterator
 
 @testset "Two-electron symmetric 4-tensor indices iterator" begin
@@ -0,0 +1,87 @@
+
+using SciAlgs.NumQuad: molecular_grid
+
+@testset "Molecular integration grid" begin
+
+   # Three spherical Gaussians, one on each atom: ∫ exp(-r²) d³r = π^(3/2)
+   xyz = [0.0 0.0 0.0;
+          1.4 0.0 0.2;
+          0.3 1.1 -0.7]
+   f(p) = sum(exp(-sum(abs2, p .- xyz[a,:])) for a in 1:3)
+
+   for radial in (:perez_jorda, :gauss_chebyshev2nd)
+
+      points, w = molecular_grid(xyz, 60, 302, radial=radial)
+      @test size(points) == (3*60*302, 3)
+      integral = sum(w[i] * f(points[i,:]) for i in eachindex(w))
+      @test isapprox(integral, 3π^1.5, rtol=1e-6)
+
+      # Without partition every atomic grid integrates everything
+      points, w = molecular_grid(xyz, [60, 50, 50], [302, 194, 302],
+                                 radial=radial, partition=:none)
+      @test size(points) == (60*302 + 50*194 + 50*302, 3)
+      integral = sum(w[i] * f(points[i,:]) for i in eachindex(w))
+      @test isapprox(integral, 9π^1.5, rtol=1e-4)
+   end
+
+   @test_throws ErrorException molecular_grid(xyz, 60, 7)
+end
+
+using SciAlgs.NumQuad: atomic_grid
+
+@testset "Cached atomic grids" begin
+
+   points, w = atomic_grid(302, 60)
+   @test size(points) == (302*60, 3)
+   @test isapprox(sum(w[i] * exp(-sum(abs2, points[i,:])) for i in eachindex(w)),
+                  π^1.5, rtol=1e-6)
+   @test atomic_grid(302, 60, radial=:gauss_chebyshev2nd)[2] != w
+
+   # Same published table from every thread
+   orders = [6, 302, 590, 5810]
+   tables = Vector{Ptr{Float64}}(undef, 1000)
+   Threads.@threads for i in eachindex(tables)
+      tables[i] = pointer(atomic_grid(orders[mod1(i, 4)], 1 + i % 7)[1])
+   end
+   for i in eachindex(tables)
+      @test tables[i] == pointer(atomic_grid(orders[mod1(i, 4)], 1 + i % 7)[1])
+   end
+
+   @test_throws ErrorException atomic_grid(302, 513)
+end
+
+using SciAlgs.NumQuad: pruned_orders, sg1_partition, pruned_molecular_grid
+
+@testset "Pruned molecular grids" begin
+
+   # Same grid as molecular_grid with a constant order per atom
+   xyz = [0.0 0.0 0.0;
+          1.4 0.0 0.2;
+          0.3 1.1 -0.7]
+   points, w = molecular_grid(xyz, [60, 50, 50], [302, 194, 302])
+   pruned = pruned_molecular_grid(xyz, [60, 50, 50],
+                                  [fill(302, 60), fill(194, 50), fill(302, 50)])
+   @test pruned == (points, w)
+
+   nang = pruned_orders(50, [0.5, 2.0], [5, 29, 11])
+   @test length(nang) == 50 && issubset(nang, [14, 302, 50])
+   @test nang[1] == 14 && nang[end] == 50 && issorted(nang[1:findlast(==(302), nang)])
+   @test_throws ErrorException pruned_orders(50, [2.0, 0.5], [5, 29, 11])
+   @test_throws ErrorException pruned_orders(50, [0.5], [5, 200])
+
+   # H₂: SG-1 regions against a single order of the same precision as the
+   # highest one, two Gaussians integrated to equal accuracy
+   xyz = [0.0 0.0 0.0;
+          0.0 0.0 1.4]
+   f(p) = sum(exp(-sum(abs2, p .- xyz[a,:])) for a in 1:2)
+   full, wfull = molecular_grid(xyz, 50, 194)
+   points, w = pruned_molecular_grid(xyz, 50, pruned_orders(50, sg1_partition(1)...))
+   @test length(w) < 0.5 * length(wfull)
+   for (p, w) in ((full, wfull), (points, w))
+      integral = sum(w[i] * f(p[i,:]) for i in eachindex(w))
+      @test isapprox(integral, 2π^1.5, rtol=1e-6)
+   end
+
+   @test_throws ErrorException sg1_partition(19)
+   @test_throws ErrorException pruned_molecular_grid(xyz, 50, fill(194, 49))
+end